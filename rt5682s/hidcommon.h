@@ -16,6 +16,7 @@
 
 #define REPORTID_MEDIA	0x01
 #define REPORTID_SPECKEYS		0x02
+#define REPORTID_PROFILE	0x03
 
 #pragma pack(1)
 typedef struct _RT5682_MEDIA_REPORT
@@ -55,4 +56,47 @@ typedef struct _CSAUDIO_SPECKEYREQ_REPORT
 } CsAudioSpecialKeyRequestReport;
 #pragma pack()
 
+//
+// Codec bring up phases reported by REPORTID_PROFILE
+//
+
+#define PROFILE_PHASE_RESET		0
+#define PROFILE_PHASE_PATCH		1
+#define PROFILE_PHASE_CALIBRATION	2
+#define PROFILE_PHASE_CLOCKS		3
+#define PROFILE_PHASE_PLATFORM		4
+#define PROFILE_PHASE_JACK		5
+#define PROFILE_PHASE_RESUME		6
+#define PROFILE_PHASE_COUNT		7
+#define PROFILE_PHASE_NONE		0xff
+
+#pragma pack(1)
+typedef struct _RT5682_PROFILE_REPORT
+{
+
+	BYTE      ReportID;
+
+	BYTE	  Resumed;
+
+	UINT16	  Events;
+
+	UINT32	  TotalUs;
+
+	UINT32	  D0Us;
+
+	UINT16	  ResumeHits;
+
+	UINT16	  ResumeMisses;
+
+	UINT32	  PhaseUs[PROFILE_PHASE_COUNT];
+
+	UINT32	  PhaseBusUs[PROFILE_PHASE_COUNT];
+
+	UINT32	  PhaseWaitUs[PROFILE_PHASE_COUNT];
+
+	UINT16	  PhaseOps[PROFILE_PHASE_COUNT];
+
+} Rt5682ProfileReport;
+#pragma pack()
+
 #endif
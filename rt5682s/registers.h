@@ -398,6 +398,458 @@
 
 #define RT5682S_MAX_REG				(RT5682S_HP_AMP_DET_CTL_4)
 
+/*
+ * Register attributes
+ *
+ * Every register above is listed once, by page (address >> 8), as
+ * X(register, reset default, flags). The lists build the attribute table,
+ * the per-page slot maps and the register cache layout in rt5682s.c.
+ */
+#define RT5682S_REG_RD				(0x1 << 0) /* readable */
+#define RT5682S_REG_VOL				(0x1 << 1) /* volatile, never cached */
+#define RT5682S_REG_WC				(0x1 << 2) /* written back to clear */
+#define RT5682S_REG_DEF				(0x1 << 3) /* reset default is known */
+#define RT5682S_REG_SEQ				(0x1 << 4) /* power sequenced, every write goes out */
+
+#define RT5682S_REG_PAGE_00(X) \
+	X(RT5682S_RESET,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CTRL_1,			0x8080, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CTRL_2,			0x0001, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HPL_GAIN,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HPR_GAIN,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2C_CTRL,			0x8007, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_BST_CTRL,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_DET_CTRL,		0x4000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_1,			0x4040, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_CBJ_CTRL_3,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_4,			0x1200, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_5,			0x200a, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_6,			0x0404, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_7,			0x0404, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CBJ_CTRL_8,			0x05a4, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DAC1_DIG_VOL,		0xffff, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO1_ADC_DIG_VOL,		0x2f2f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO1_ADC_BOOST,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_GAIN_1,		0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_GAIN_2,		0x0039, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SIDETONE_CTRL,		0x000b, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO1_ADC_MIXER,		0xc0c4, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_AD_DA_MIXER,		0x8080, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO1_DAC_MIXER,		0xa0a0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_A_DAC1_MUX,			0x0300, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DIG_INF2_DATA,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_REC_MIXER,			0x08c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CAL_REC,			0x1818, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_ANA_OST_CTRL_1,		0x00c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_ANA_OST_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_ANA_OST_CTRL_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PWR_DIG_1,			0x00c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PWR_DIG_2,			0x008a, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PWR_ANLG_1,			0x0800, RT5682S_REG_RD | RT5682S_REG_DEF | RT5682S_REG_SEQ) \
+	X(RT5682S_PWR_ANLG_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF | RT5682S_REG_SEQ) \
+	X(RT5682S_PWR_ANLG_3,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF | RT5682S_REG_SEQ) \
+	X(RT5682S_PWR_MIXER,			0x0030, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_MB_CTRL,			0x000c, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CLK_GATE_TCON_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CLK_GATE_TCON_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CLK_GATE_TCON_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CLK_DET,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_RESET_LPF_CTRL,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_RESET_HPF_CTRL,		0x2200, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DMIC_CTRL_1,		0x0810, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_LPF_AD_DMIC,		0xcc00, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S1_SDP,			0x3000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S2_SDP,			0x3000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_ADDA_CLK_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_ADDA_CLK_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S1_F_DIV_CTRL_1,		0x0002, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S1_F_DIV_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_TDM_CTRL,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TDM_ADDA_CTRL_1,		0x0003, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TDM_ADDA_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DATA_SEL_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TDM_TCON_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TDM_TCON_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_GLB_CLK,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_4,		0x0005, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_11,		0x0003, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DEPOP_1,			0x0060, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CHARGE_PUMP_1,		0x4da1, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CHARGE_PUMP_2,		0x1c15, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CHARGE_PUMP_3,		0x0425, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_MICBIAS_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_MICBIAS_2,			0x0080, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_MICBIAS_3,			0x008f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_12,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_TRACK_14,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_3,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_4,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_5,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_6,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_CTRL_7,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_RC_CLK_CTRL,		0x0009, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S2_M_CLK_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S2_F_DIV_CTRL_1,		0x0002, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_I2S2_F_DIV_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_IRQ_CTRL_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IRQ_CTRL_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IRQ_CTRL_3,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IRQ_CTRL_4,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_INT_ST_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_GPIO_CTRL_1,		0x0160, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_GPIO_CTRL_2,		0x82a0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_GPIO_ST,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_AMP_DET_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_MID_HP_AMP_DET,		0x3300, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_LOW_HP_AMP_DET,		0x2200, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DELAY_BUF_CTRL,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SV_ZCD_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SV_ZCD_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IL_CMD_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_IL_CMD_2,			0x00c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IL_CMD_3,			0x2220, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IL_CMD_4,			0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IL_CMD_5,			0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_IL_CMD_6,			0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL | RT5682S_REG_WC) \
+	X(RT5682S_4BTN_IL_CMD_2,		0x4000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_3,		0x0aa0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_4,		0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_5,		0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_6,		0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_4BTN_IL_CMD_7,		0x3131, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_ADC_STO1_HP_CTRL_1,		0xb320, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_ADC_STO1_HP_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_AJD1_CTRL,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_JD_CTRL_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DUMMY_1,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_DUMMY_2,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_DUMMY_3,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_VERSION_ID,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_VENDOR_ID,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_DEVICE_ID,			0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_01(X) \
+	X(RT5682S_DAC_ADC_DIG_VOL1,		0xa000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_2,		0x0066, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_3,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_4,		0x2202, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_5,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_6,		0xa800, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_7,		0x0006, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_8,		0x0460, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_9,		0x2000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_10,		0x0200, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_VREF_REC_OP_FB_CAP_CTRL_1,	0x8000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_VREF_REC_OP_FB_CAP_CTRL_2,	0x0303, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CHARGE_PUMP_1,		0x0020, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DIG_IN_CTRL_1,		0x5026, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PAD_DRIVING_CTRL,		0x8000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CHOP_DAC_1,			0x0005, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CHOP_DAC_2,			0x3030, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CHOP_ADC,			0xa000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_CALIB_ADC_CTRL,		0x4110, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_VOL_TEST,			0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SPKVDD_DET_ST,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TEST_MODE_CTRL_1,		0x0022, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TEST_MODE_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TEST_MODE_CTRL_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_TEST_MODE_CTRL_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_INTERNAL_1,		0x0022, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_INTERNAL_2,		0x0303, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_INTERNAL_3,		0x2222, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_PLL_INTERNAL_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_STO_NG2_CTRL_2,		0x0080, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_3,		0x0200, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_4,		0x0800, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_STO_NG2_CTRL_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_STO_NG2_CTRL_7,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_STO_NG2_CTRL_8,		0x000f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_9,		0x000f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO_NG2_CTRL_10,		0x0001, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_STO1_DAC_SIL_DET,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SIL_PSV_CTRL1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SIL_PSV_CTRL2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SIL_PSV_CTRL3,		0x0022, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SIL_PSV_CTRL4,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SIL_PSV_CTRL5,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_7,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_8,		0x0017, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_9,		0x004b, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_10,	0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_11,	0x03e8, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_12,	0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_13,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_14,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_15,	0xb5b6, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_16,	0x9124, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_17,	0x4924, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_18,	0x0009, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_19,	0x0018, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_20,	0x002a, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_21,	0x004c, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_22,	0x0097, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_23,	0x01c3, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_24,	0x03e9, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_25,	0x1389, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_26,	0xc351, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_27,	0x02a0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_28,	0x0b0f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_29,	0x402f, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_30,	0x0702, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_31,	0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_32,	0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_33,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_34,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_35,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_36,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_37,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_38,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_39,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_40,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_41,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_42,	0x5757, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_IMP_SENS_CTRL_43,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_44,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_45,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_IMP_SENS_CTRL_46,	0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_LOGIC_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_LOGIC_CTRL_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_LOGIC_CTRL_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_CTRL_2,		0x0320, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_3,		0x06a1, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_7,		0x0001, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_8,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_9,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_CTRL_10,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_CTRL_11,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_HP_CALIB_ST_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_7,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_8,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_9,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_10,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HP_CALIB_ST_11,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_02(X) \
+	X(RT5682S_SAR_IL_CMD_1,		0x6297, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_6,		0x0102, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_7,		0x00a3, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_8,		0x0048, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_9,		0xa2c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_10,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_11,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_SAR_IL_CMD_12,		0x00c0, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_13,		0x0000, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_SAR_IL_CMD_14,		0x024c, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_DUMMY_4,			0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DUMMY_5,			0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DUMMY_6,			0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_03(X) \
+	X(RT5682S_VERSION_ID_HIDE,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_VERSION_ID_CUS,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_05(X) \
+	X(RT5682S_SCAN_CTL,			0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_06(X) \
+	X(RT5682S_HP_AMP_DET,			0x0000, RT5682S_REG_RD) \
+	X(RT5682S_BIAS_CUR_CTRL_11,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_12,		0xa9aa, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_13,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_14,		0xa9aa, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_15,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_16,		0xa9aa, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_17,		0x6666, RT5682S_REG_RD | RT5682S_REG_DEF) \
+	X(RT5682S_BIAS_CUR_CTRL_18,		0xa9aa, RT5682S_REG_RD | RT5682S_REG_DEF)
+
+#define RT5682S_REG_PAGE_07(X) \
+	X(RT5682S_I2C_TRANS_CTRL,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_08(X) \
+	X(RT5682S_DUMMY_7,			0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DUMMY_8,			0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_0d(X) \
+	X(RT5682S_DMIC_FLOAT_DET,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_11(X) \
+	X(RT5682S_HA_CMP_OP_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_HA_CMP_OP_2,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_4,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_5,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_6,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_7,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_8,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_9,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_10,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_11,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_12,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_13,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_14,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_15,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_16,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_17,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_18,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_19,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_20,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_21,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_22,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_23,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_24,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HA_CMP_OP_25,		0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_14(X) \
+	X(RT5682S_NEW_CBJ_DET_CTL_1,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_2,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_4,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_5,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_6,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_7,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_8,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_9,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_NEW_CBJ_DET_CTL_10,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_11,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_12,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_13,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_14,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_15,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_NEW_CBJ_DET_CTL_16,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_18(X) \
+	X(RT5682S_DA_FILTER_1,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DA_FILTER_2,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DA_FILTER_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DA_FILTER_4,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_DA_FILTER_5,		0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_2c(X) \
+	X(RT5682S_CLK_SW_TEST_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL)
+
+#define RT5682S_REG_PAGE_34(X) \
+	X(RT5682S_CLK_SW_TEST_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_CLK_SW_TEST_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_4,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_5,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_6,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_7,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_8,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_9,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_10,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_11,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_12,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_13,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_CLK_SW_TEST_14,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_1,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_2,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_4,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_5,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_MANU_WRITE_6,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_READ_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_2,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_3,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_4,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_5,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_6,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_7,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_8,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_9,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_10,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_11,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_12,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_13,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_14,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_15,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_16,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_17,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_READ_18,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_EFUSE_TIMING_CTL_1,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_EFUSE_TIMING_CTL_2,		0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_35(X) \
+	X(RT5682S_PILOT_DIG_CTL_1,		0x0000, RT5682S_REG_RD | RT5682S_REG_VOL) \
+	X(RT5682S_PILOT_DIG_CTL_2,		0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGE_3b(X) \
+	X(RT5682S_HP_AMP_DET_CTL_1,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HP_AMP_DET_CTL_2,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HP_AMP_DET_CTL_3,		0x0000, RT5682S_REG_RD) \
+	X(RT5682S_HP_AMP_DET_CTL_4,		0x0000, RT5682S_REG_RD)
+
+#define RT5682S_REG_PAGES(X) \
+	X(00) X(01) X(02) X(03) X(05) X(06) X(07) X(08) X(0d) X(11) X(14) X(18) X(2c) X(34) X(35) X(3b)
+
+#define RT5682S_REG_SLOT(reg, def, flags)	reg##_SLOT,
+
+enum { RT5682S_REG_PAGE_00(RT5682S_REG_SLOT) RT5682S_REG_PAGE_00_COUNT };
+enum { RT5682S_REG_PAGE_01(RT5682S_REG_SLOT) RT5682S_REG_PAGE_01_COUNT };
+enum { RT5682S_REG_PAGE_02(RT5682S_REG_SLOT) RT5682S_REG_PAGE_02_COUNT };
+enum { RT5682S_REG_PAGE_03(RT5682S_REG_SLOT) RT5682S_REG_PAGE_03_COUNT };
+enum { RT5682S_REG_PAGE_05(RT5682S_REG_SLOT) RT5682S_REG_PAGE_05_COUNT };
+enum { RT5682S_REG_PAGE_06(RT5682S_REG_SLOT) RT5682S_REG_PAGE_06_COUNT };
+enum { RT5682S_REG_PAGE_07(RT5682S_REG_SLOT) RT5682S_REG_PAGE_07_COUNT };
+enum { RT5682S_REG_PAGE_08(RT5682S_REG_SLOT) RT5682S_REG_PAGE_08_COUNT };
+enum { RT5682S_REG_PAGE_0d(RT5682S_REG_SLOT) RT5682S_REG_PAGE_0d_COUNT };
+enum { RT5682S_REG_PAGE_11(RT5682S_REG_SLOT) RT5682S_REG_PAGE_11_COUNT };
+enum { RT5682S_REG_PAGE_14(RT5682S_REG_SLOT) RT5682S_REG_PAGE_14_COUNT };
+enum { RT5682S_REG_PAGE_18(RT5682S_REG_SLOT) RT5682S_REG_PAGE_18_COUNT };
+enum { RT5682S_REG_PAGE_2c(RT5682S_REG_SLOT) RT5682S_REG_PAGE_2c_COUNT };
+enum { RT5682S_REG_PAGE_34(RT5682S_REG_SLOT) RT5682S_REG_PAGE_34_COUNT };
+enum { RT5682S_REG_PAGE_35(RT5682S_REG_SLOT) RT5682S_REG_PAGE_35_COUNT };
+enum { RT5682S_REG_PAGE_3b(RT5682S_REG_SLOT) RT5682S_REG_PAGE_3b_COUNT };
+
+enum {
+	RT5682S_REG_PAGE_00_BASE = 0,
+	RT5682S_REG_PAGE_01_BASE = RT5682S_REG_PAGE_00_BASE + RT5682S_REG_PAGE_00_COUNT,
+	RT5682S_REG_PAGE_02_BASE = RT5682S_REG_PAGE_01_BASE + RT5682S_REG_PAGE_01_COUNT,
+	RT5682S_REG_PAGE_03_BASE = RT5682S_REG_PAGE_02_BASE + RT5682S_REG_PAGE_02_COUNT,
+	RT5682S_REG_PAGE_05_BASE = RT5682S_REG_PAGE_03_BASE + RT5682S_REG_PAGE_03_COUNT,
+	RT5682S_REG_PAGE_06_BASE = RT5682S_REG_PAGE_05_BASE + RT5682S_REG_PAGE_05_COUNT,
+	RT5682S_REG_PAGE_07_BASE = RT5682S_REG_PAGE_06_BASE + RT5682S_REG_PAGE_06_COUNT,
+	RT5682S_REG_PAGE_08_BASE = RT5682S_REG_PAGE_07_BASE + RT5682S_REG_PAGE_07_COUNT,
+	RT5682S_REG_PAGE_0d_BASE = RT5682S_REG_PAGE_08_BASE + RT5682S_REG_PAGE_08_COUNT,
+	RT5682S_REG_PAGE_11_BASE = RT5682S_REG_PAGE_0d_BASE + RT5682S_REG_PAGE_0d_COUNT,
+	RT5682S_REG_PAGE_14_BASE = RT5682S_REG_PAGE_11_BASE + RT5682S_REG_PAGE_11_COUNT,
+	RT5682S_REG_PAGE_18_BASE = RT5682S_REG_PAGE_14_BASE + RT5682S_REG_PAGE_14_COUNT,
+	RT5682S_REG_PAGE_2c_BASE = RT5682S_REG_PAGE_18_BASE + RT5682S_REG_PAGE_18_COUNT,
+	RT5682S_REG_PAGE_34_BASE = RT5682S_REG_PAGE_2c_BASE + RT5682S_REG_PAGE_2c_COUNT,
+	RT5682S_REG_PAGE_35_BASE = RT5682S_REG_PAGE_34_BASE + RT5682S_REG_PAGE_34_COUNT,
+	RT5682S_REG_PAGE_3b_BASE = RT5682S_REG_PAGE_35_BASE + RT5682S_REG_PAGE_35_COUNT,
+	RT5682S_REG_COUNT = RT5682S_REG_PAGE_3b_BASE + RT5682S_REG_PAGE_3b_COUNT
+};
+
 /* global definition */
 #define RT5682S_L_MUTE				(0x1 << 15)
 #define RT5682S_L_MUTE_SFT			15
@@ -16,6 +16,9 @@ NTSTATUS rt5682s_set_tdm_slot(PRTEK_CONTEXT  pDevice, unsigned int tx_mask,
 NTSTATUS rt5682s_set_component_sysclk(PRTEK_CONTEXT  pDevice,
 	int clk_id);
 void rt5682s_update_reclock(IN PRTEK_CONTEXT pDevice);
+void RtekQueueJdetWorkItem(WDFDEVICE Device);
+NTSTATUS RtekQueueBootWorkItem(WDFDEVICE Device);
+void RtekQueueReclockWorkItem(WDFDEVICE Device);
 
 unsigned int __sw_hweight32(unsigned int w)
 {
@@ -65,23 +68,254 @@ DriverEntry(
 }
 
 
-static NTSTATUS rt5682s_reg_write(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t data)
+struct rt5682s_reg_attr {
+	UINT16 reg;
+	UINT16 def;
+	UINT8 flags;
+};
+
+#define RT5682S_REG_ATTR(reg, def, flags)	{ reg, def, flags },
+#define RT5682S_REG_ATTR_PAGE(page)		RT5682S_REG_PAGE_##page(RT5682S_REG_ATTR)
+
+static const struct rt5682s_reg_attr rt5682s_reg_attrs[RT5682S_REG_COUNT] = {
+	RT5682S_REG_PAGES(RT5682S_REG_ATTR_PAGE)
+};
+
+//Per-page maps from (reg & 0xff) to 1 + the page relative slot, 0 if undefined
+#define RT5682S_REG_MAP(reg, def, flags)	[(reg) & 0xff] = reg##_SLOT + 1,
+#define RT5682S_REG_MAP_PAGE(page)		\
+	static const UINT8 rt5682s_reg_map_##page[0x100] = { RT5682S_REG_PAGE_##page(RT5682S_REG_MAP) };
+
+RT5682S_REG_PAGES(RT5682S_REG_MAP_PAGE)
+
+static const struct {
+	UINT16 base;
+	const UINT8* map;
+} rt5682s_reg_pages[(RT5682S_MAX_REG >> 8) + 1] = {
+#define RT5682S_REG_DIR_PAGE(page)		[0x##page] = { RT5682S_REG_PAGE_##page##_BASE, rt5682s_reg_map_##page },
+	RT5682S_REG_PAGES(RT5682S_REG_DIR_PAGE)
+#undef RT5682S_REG_DIR_PAGE
+};
+
+static int rt5682s_reg_slot(uint16_t reg)
+{
+	UINT16 page = reg >> 8;
+	if (page >= sizeof(rt5682s_reg_pages) / sizeof(rt5682s_reg_pages[0]) ||
+		!rt5682s_reg_pages[page].map)
+		return -1;
+
+	UINT8 offset = rt5682s_reg_pages[page].map[reg & 0xff];
+	if (!offset)
+		return -1;
+
+	return rt5682s_reg_pages[page].base + offset - 1;
+}
+
+static UINT8 rt5682s_reg_flags(uint16_t reg)
+{
+	int slot = rt5682s_reg_slot(reg);
+	return slot < 0 ? 0 : rt5682s_reg_attrs[slot].flags;
+}
+
+static BOOLEAN rt5682s_volatile_register(uint16_t reg)
+{
+	return (rt5682s_reg_flags(reg) & RT5682S_REG_VOL) != 0;
+}
+
+static BOOLEAN rt5682s_cache_get(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data)
+{
+	int slot = rt5682s_reg_slot(reg);
+	if (slot < 0 || (rt5682s_reg_attrs[slot].flags & RT5682S_REG_VOL))
+		return false;
+
+	if (!(pDevice->RegCacheValid[slot / 32] & (1UL << (slot % 32))))
+		return false;
+
+	*data = pDevice->RegCache[slot];
+	return true;
+}
+
+static void rt5682s_cache_set(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t data)
+{
+	int slot = rt5682s_reg_slot(reg);
+	if (slot < 0 || (rt5682s_reg_attrs[slot].flags & RT5682S_REG_VOL))
+		return;
+
+	pDevice->RegCache[slot] = data;
+	pDevice->RegCacheValid[slot / 32] |= (1UL << (slot % 32));
+}
+
+static void rt5682s_cache_drop(PRTEK_CONTEXT pDevice, uint16_t reg)
+{
+	int slot = rt5682s_reg_slot(reg);
+	if (slot >= 0)
+		pDevice->RegCacheValid[slot / 32] &= ~(1UL << (slot % 32));
+}
+
+static void rt5682s_cache_reset(PRTEK_CONTEXT pDevice)
+{
+	RtlZeroMemory(pDevice->RegCacheValid, sizeof(pDevice->RegCacheValid));
+}
+
+//A successful reset leaves every register with a known default at that default
+static void rt5682s_cache_load_defaults(PRTEK_CONTEXT pDevice)
+{
+	rt5682s_cache_reset(pDevice);
+	for (int slot = 0; slot < RT5682S_REG_COUNT; slot++) {
+		const struct rt5682s_reg_attr* attr = &rt5682s_reg_attrs[slot];
+		if ((attr->flags & (RT5682S_REG_DEF | RT5682S_REG_VOL)) != RT5682S_REG_DEF)
+			continue;
+
+		pDevice->RegCache[slot] = attr->def;
+		pDevice->RegCacheValid[slot / 32] |= (1UL << (slot % 32));
+	}
+}
+
+static void rt5682s_cache_written(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t data, NTSTATUS status)
+{
+	//Register contents are unknown after a failed write or a failed reset
+	if (reg == RT5682S_RESET && NT_SUCCESS(status))
+		rt5682s_cache_load_defaults(pDevice);
+	else if (reg == RT5682S_RESET)
+		rt5682s_cache_reset(pDevice);
+	else if (NT_SUCCESS(status))
+		rt5682s_cache_set(pDevice, reg, data);
+	else
+		rt5682s_cache_drop(pDevice, reg);
+}
+
+//
+// All register traffic runs under RegCacheLock and goes straight to the SPB
+// target from the thread holding it. Checked builds keep hold times in
+// performance counter ticks.
+//
+static void rt5682s_reg_lock(PRTEK_CONTEXT pDevice)
+{
+	WdfWaitLockAcquire(pDevice->RegCacheLock, NULL);
+#if DBG
+	pDevice->RegLockAcquired = KeQueryPerformanceCounter(NULL);
+#endif
+}
+
+static void rt5682s_reg_unlock(PRTEK_CONTEXT pDevice)
+{
+#if DBG
+	LONGLONG held = KeQueryPerformanceCounter(NULL).QuadPart - pDevice->RegLockAcquired.QuadPart;
+
+	pDevice->RegLockHoldTotal += held;
+	if (held > pDevice->RegLockHoldMax)
+		pDevice->RegLockHoldMax = held;
+	pDevice->RegLockCount++;
+#endif
+
+	WdfWaitLockRelease(pDevice->RegCacheLock);
+}
+
+//
+// Profiler events are timed from a start stamp taken before the transfer or
+// wait. Only the thread bringing the codec up adds to the phase summary,
+// jack detect traffic in the same window still lands in the ring.
+//
+static LONGLONG rt5682s_prof_now(void)
+{
+#if RT5682S_PROFILE
+	return KeQueryPerformanceCounter(NULL).QuadPart;
+#else
+	return 0;
+#endif
+}
+
+static void rt5682s_prof_event(PRTEK_CONTEXT pDevice, ProfEventType type, uint16_t reg, uint16_t val, LONGLONG start)
+{
+#if RT5682S_PROFILE
+	RT5682S_PROFILER* prof = &pDevice->Profiler;
+	LONGLONG ticks = KeQueryPerformanceCounter(NULL).QuadPart - start;
+	RT5682S_PROF_EVENT* event = &prof->Ring[(ULONG)(InterlockedIncrement(&prof->Next) - 1) & (RT5682S_PROF_RING_SIZE - 1)];
+
+	event->Start = start;
+	event->Ticks = (ULONG)min(ticks, MAXULONG);
+	event->Reg = reg;
+	event->Value = val;
+	event->Type = (UCHAR)type;
+	event->Phase = prof->Phase;
+
+	if (prof->Thread != KeGetCurrentThread() || prof->Phase >= PROFILE_PHASE_COUNT)
+		return;
+
+	prof->PhaseOps[prof->Phase]++;
+	if (type == ProfEventDelay || type == ProfEventPoll)
+		prof->PhaseWaitTicks[prof->Phase] += ticks;
+	else
+		prof->PhaseBusTicks[prof->Phase] += ticks;
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+	UNREFERENCED_PARAMETER(type);
+	UNREFERENCED_PARAMETER(reg);
+	UNREFERENCED_PARAMETER(val);
+	UNREFERENCED_PARAMETER(start);
+#endif
+}
+
+static void rt5682s_prof_phase(PRTEK_CONTEXT pDevice, UCHAR phase)
+{
+#if RT5682S_PROFILE
+	RT5682S_PROFILER* prof = &pDevice->Profiler;
+	LONGLONG now = KeQueryPerformanceCounter(NULL).QuadPart;
+
+	if (prof->Phase < PROFILE_PHASE_COUNT)
+		prof->PhaseTicks[prof->Phase] += now - prof->PhaseStart;
+	prof->Phase = phase;
+	prof->PhaseStart = now;
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+	UNREFERENCED_PARAMETER(phase);
+#endif
+}
+
+static NTSTATUS rt5682s_reg_raw_write(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t data)
 {
 	uint16_t rawdata[2];
 	rawdata[0] = RtlUshortByteSwap(reg);
 	rawdata[1] = RtlUshortByteSwap(data);
-	return SpbWriteDataSynchronously(&pDevice->I2CContext, rawdata, sizeof(rawdata));
+	LONGLONG start = rt5682s_prof_now();
+	NTSTATUS status = SpbWriteDataSynchronously(&pDevice->I2CContext, rawdata, sizeof(rawdata));
+	rt5682s_prof_event(pDevice, ProfEventWrite, reg, data, start);
+	rt5682s_cache_written(pDevice, reg, data, status);
+	return status;
 }
 
-static NTSTATUS rt5682s_reg_read(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data)
+static NTSTATUS rt5682s_reg_raw_read(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data)
 {
+	if (rt5682s_cache_get(pDevice, reg, data))
+		return STATUS_SUCCESS;
+
 	uint16_t reg_swap = RtlUshortByteSwap(reg);
 	uint16_t data_swap = 0;
+	LONGLONG start = rt5682s_prof_now();
 	NTSTATUS ret = SpbXferDataSynchronously(&pDevice->I2CContext, &reg_swap, sizeof(uint16_t), &data_swap, sizeof(uint16_t));
 	*data = RtlUshortByteSwap(data_swap);
+	rt5682s_prof_event(pDevice, ProfEventRead, reg, *data, start);
+	if (NT_SUCCESS(ret))
+		rt5682s_cache_set(pDevice, reg, *data);
 	return ret;
 }
 
+static NTSTATUS rt5682s_reg_write(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t data)
+{
+	rt5682s_reg_lock(pDevice);
+	NTSTATUS status = rt5682s_reg_raw_write(pDevice, reg, data);
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
+static NTSTATUS rt5682s_reg_read(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data)
+{
+	rt5682s_reg_lock(pDevice);
+	NTSTATUS status = rt5682s_reg_raw_read(pDevice, reg, data);
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
 static NTSTATUS rt5682s_reg_update(
 	_In_ PRTEK_CONTEXT pDevice,
 	uint16_t reg,
@@ -90,120 +324,1219 @@ static NTSTATUS rt5682s_reg_update(
 ) {
 	uint16_t tmp = 0, orig = 0;
 
-	NTSTATUS status = rt5682s_reg_read(pDevice, reg, &orig);
-	if (!NT_SUCCESS(status)) {
-		return status;
+	rt5682s_reg_lock(pDevice);
+
+	NTSTATUS status = rt5682s_reg_raw_read(pDevice, reg, &orig);
+	if (!NT_SUCCESS(status)) {
+		goto exit;
+	}
+
+	tmp = orig & ~mask;
+	tmp |= val & mask;
+
+	if (tmp != orig) {
+		status = rt5682s_reg_raw_write(pDevice, reg, tmp);
+	}
+
+exit:
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
+//
+// Block transfers send one register address and let the codec auto-increment
+// it for every following 16 bit word. Runs are split at undefined addresses
+// and after RT5682S_BLOCK_MAX registers. Until rt5682s_probe_block_access
+// has seen the codec auto-increment, every run is a single register.
+//
+#define RT5682S_BLOCK_MAX 16
+
+static int rt5682s_block_run(PRTEK_CONTEXT pDevice, uint16_t reg, int count)
+{
+	int run = 1;
+	while (pDevice->BlockAutoInc && run < count && run < RT5682S_BLOCK_MAX && rt5682s_reg_slot(reg + run) >= 0)
+		run++;
+	return run;
+}
+
+static NTSTATUS rt5682s_reg_raw_block_read(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data, int count)
+{
+	NTSTATUS status = STATUS_SUCCESS;
+
+	for (int off = 0; off < count; ) {
+		int run = rt5682s_block_run(pDevice, reg + off, count - off);
+
+		int cached = 0;
+		while (cached < run && rt5682s_cache_get(pDevice, reg + off + cached, &data[off + cached]))
+			cached++;
+
+		if (cached < run) {
+			uint16_t reg_swap = RtlUshortByteSwap(reg + off);
+			LONGLONG start = rt5682s_prof_now();
+			status = SpbXferDataSynchronously(&pDevice->I2CContext, &reg_swap, sizeof(uint16_t),
+				&data[off], sizeof(uint16_t) * run);
+			rt5682s_prof_event(pDevice, ProfEventBlockRead, reg + off, (uint16_t)run, start);
+			if (!NT_SUCCESS(status))
+				return status;
+
+			for (int i = off; i < off + run; i++) {
+				data[i] = RtlUshortByteSwap(data[i]);
+				rt5682s_cache_set(pDevice, reg + i, data[i]);
+			}
+		}
+
+		off += run;
+	}
+	return status;
+}
+
+static NTSTATUS rt5682s_reg_raw_block_write(PRTEK_CONTEXT pDevice, uint16_t reg, const uint16_t* data, int count)
+{
+	NTSTATUS status = STATUS_SUCCESS;
+	uint16_t frame[1 + RT5682S_BLOCK_MAX];
+
+	for (int off = 0; off < count; ) {
+		int run = rt5682s_block_run(pDevice, reg + off, count - off);
+
+		frame[0] = RtlUshortByteSwap(reg + off);
+		for (int i = 0; i < run; i++)
+			frame[1 + i] = RtlUshortByteSwap(data[off + i]);
+
+		LONGLONG start = rt5682s_prof_now();
+		status = SpbWriteDataSynchronously(&pDevice->I2CContext, frame, sizeof(uint16_t) * (1 + run));
+		rt5682s_prof_event(pDevice, ProfEventBlockWrite, reg + off, (uint16_t)run, start);
+		for (int i = off; i < off + run; i++)
+			rt5682s_cache_written(pDevice, reg + i, data[i], status);
+		if (!NT_SUCCESS(status))
+			return status;
+
+		off += run;
+	}
+	return status;
+}
+
+//Masked update of up to RT5682S_BLOCK_MAX consecutive registers, writing only the changed span
+static NTSTATUS rt5682s_reg_raw_block_update(PRTEK_CONTEXT pDevice, uint16_t reg, int count,
+	const uint16_t* masks, const uint16_t* vals)
+{
+	uint16_t data[RT5682S_BLOCK_MAX];
+
+	if (count <= 0 || count > RT5682S_BLOCK_MAX)
+		return STATUS_INVALID_PARAMETER;
+
+	NTSTATUS status = rt5682s_reg_raw_block_read(pDevice, reg, data, count);
+	if (!NT_SUCCESS(status))
+		return status;
+
+	int first = -1, last = -1;
+	for (int i = 0; i < count; i++) {
+		uint16_t tmp = (data[i] & ~masks[i]) | (vals[i] & masks[i]);
+		if (tmp != data[i]) {
+			data[i] = tmp;
+			if (first < 0)
+				first = i;
+			last = i;
+		}
+	}
+
+	if (first < 0)
+		return STATUS_SUCCESS;
+
+	return rt5682s_reg_raw_block_write(pDevice, reg + first, &data[first], last - first + 1);
+}
+
+//
+// Once per device the DUMMY_1..3 scratch registers are written as a block,
+// read back one by one and read again as a block. Block transfers stay off
+// unless all three agree.
+//
+static void rt5682s_probe_block_access(PRTEK_CONTEXT pDevice)
+{
+	static const uint16_t pattern[RT5682S_SIGNATURE_COUNT] = { 0x5a01, 0xa502, 0x3c03 };
+	uint16_t single[RT5682S_SIGNATURE_COUNT], block[RT5682S_SIGNATURE_COUNT];
+
+	rt5682s_reg_lock(pDevice);
+
+	pDevice->BlockAutoInc = TRUE;
+	BOOLEAN ok = NT_SUCCESS(rt5682s_reg_raw_block_write(pDevice, RT5682S_DUMMY_1, pattern, RT5682S_SIGNATURE_COUNT));
+	for (int i = 0; ok && i < RT5682S_SIGNATURE_COUNT; i++)
+		ok = NT_SUCCESS(rt5682s_reg_raw_read(pDevice, RT5682S_DUMMY_1 + i, &single[i]));
+	ok = ok && NT_SUCCESS(rt5682s_reg_raw_block_read(pDevice, RT5682S_DUMMY_1, block, RT5682S_SIGNATURE_COUNT)) &&
+		RtlCompareMemory(single, pattern, sizeof(pattern)) == sizeof(pattern) &&
+		RtlCompareMemory(block, pattern, sizeof(pattern)) == sizeof(pattern);
+
+	pDevice->BlockAutoInc = ok;
+	pDevice->BlockProbed = TRUE;
+
+	rt5682s_reg_unlock(pDevice);
+
+	RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "Register auto-increment %s\n",
+		ok ? "works, using block transfers" : "failed, using single registers");
+}
+
+static NTSTATUS rt5682s_reg_block_read(PRTEK_CONTEXT pDevice, uint16_t reg, uint16_t* data, int count)
+{
+	rt5682s_reg_lock(pDevice);
+	NTSTATUS status = rt5682s_reg_raw_block_read(pDevice, reg, data, count);
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
+static NTSTATUS rt5682s_reg_block_update(PRTEK_CONTEXT pDevice, uint16_t reg, int count,
+	const uint16_t* masks, const uint16_t* vals)
+{
+	rt5682s_reg_lock(pDevice);
+	NTSTATUS status = rt5682s_reg_raw_block_update(pDevice, reg, count, masks, vals);
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
+//Caller holds RegCacheLock and provides one SPB_BURST_INFO and 2 frames per register
+static NTSTATUS rt5682s_reg_raw_burstWrite(PRTEK_CONTEXT pDevice, struct reg* regs, int regCount,
+	SPB_BURST_INFO* burstInfo, uint16_t* frames) {
+	for (int i = 0; i < regCount; i++) {
+		frames[i * 2] = RtlUshortByteSwap(regs[i].reg);
+		frames[i * 2 + 1] = RtlUshortByteSwap(regs[i].val);
+		burstInfo[i].Data = &frames[i * 2];
+		burstInfo[i].Length = sizeof(uint16_t) * 2;
+	}
+
+	LONGLONG start = rt5682s_prof_now();
+	NTSTATUS status = SpbBurstWriteDataSynchronously(&pDevice->I2CContext, burstInfo, regCount);
+	rt5682s_prof_event(pDevice, ProfEventBurst, regs[0].reg, (uint16_t)regCount, start);
+	for (int i = 0; i < regCount; i++) {
+		rt5682s_cache_written(pDevice, regs[i].reg, regs[i].val, status);
+	}
+	return status;
+}
+
+//
+// Register batches hold RegCacheLock from begin to commit and queue writes
+// and masked updates, sending each run between delays as one SPB sequence.
+// Back to back updates of the same register merge into a single write, and
+// writes to different registers always go out in the order they were queued.
+// Updates of volatile registers flush the queue and read the bus. Power
+// sequenced registers are never merged, every step of a power sequence
+// reaches the codec.
+//
+#define RT5682S_BATCH_MAX 32
+
+struct rt5682s_batch {
+	PRTEK_CONTEXT pDevice;
+	NTSTATUS status;
+	BOOLEAN merge;		//Back to back updates of one register may share a write
+	ULONGLONG settleEnd;
+	int count;
+	struct reg regs[RT5682S_BATCH_MAX];
+	SPB_BURST_INFO burstInfo[RT5682S_BATCH_MAX];
+	uint16_t frames[RT5682S_BATCH_MAX * 2];
+};
+
+static void rt5682s_batch_begin(PRTEK_CONTEXT pDevice, struct rt5682s_batch* batch)
+{
+	batch->pDevice = pDevice;
+	batch->status = STATUS_SUCCESS;
+	batch->merge = TRUE;
+	batch->settleEnd = 0;
+	batch->count = 0;
+	rt5682s_reg_lock(pDevice);
+}
+
+static void rt5682s_batch_flush(struct rt5682s_batch* batch)
+{
+	if (batch->count && NT_SUCCESS(batch->status)) {
+		batch->status = rt5682s_reg_raw_burstWrite(batch->pDevice, batch->regs, batch->count,
+			batch->burstInfo, batch->frames);
+	}
+	batch->count = 0;
+}
+
+static void rt5682s_batch_queue(struct rt5682s_batch* batch, uint16_t reg, uint16_t val)
+{
+	if (batch->count >= RT5682S_BATCH_MAX)
+		rt5682s_batch_flush(batch);
+
+	batch->regs[batch->count].reg = reg;
+	batch->regs[batch->count].val = val;
+	batch->count++;
+}
+
+static BOOLEAN rt5682s_batch_can_merge(struct rt5682s_batch* batch, uint16_t reg)
+{
+	return batch->merge && batch->count && batch->regs[batch->count - 1].reg == reg &&
+		!(rt5682s_reg_flags(reg) & (RT5682S_REG_VOL | RT5682S_REG_SEQ));
+}
+
+static void rt5682s_batch_write(struct rt5682s_batch* batch, uint16_t reg, uint16_t val)
+{
+	if (!NT_SUCCESS(batch->status))
+		return;
+
+	if (reg == RT5682S_RESET) {
+		rt5682s_batch_flush(batch);
+		if (NT_SUCCESS(batch->status))
+			batch->status = rt5682s_reg_raw_write(batch->pDevice, reg, val);
+		return;
+	}
+
+	if (rt5682s_batch_can_merge(batch, reg)) {
+		batch->regs[batch->count - 1].val = val;
+		return;
+	}
+
+	rt5682s_batch_queue(batch, reg, val);
+}
+
+static void rt5682s_batch_update(struct rt5682s_batch* batch, uint16_t reg, uint16_t mask, uint16_t val)
+{
+	uint16_t orig = 0, tmp;
+
+	if (!NT_SUCCESS(batch->status))
+		return;
+
+	if (rt5682s_volatile_register(reg)) {
+		rt5682s_batch_flush(batch);
+		if (!NT_SUCCESS(batch->status))
+			return;
+
+		batch->status = rt5682s_reg_raw_read(batch->pDevice, reg, &orig);
+		if (!NT_SUCCESS(batch->status))
+			return;
+
+		tmp = (orig & ~mask) | (val & mask);
+		if (tmp != orig)
+			batch->status = rt5682s_reg_raw_write(batch->pDevice, reg, tmp);
+		return;
+	}
+
+	if (rt5682s_batch_can_merge(batch, reg)) {
+		struct reg* last = &batch->regs[batch->count - 1];
+		last->val = (last->val & ~mask) | (val & mask);
+		return;
+	}
+
+	//Queued writes are newer than the cache
+	int i;
+	for (i = batch->count - 1; i >= 0; i--) {
+		if (batch->regs[i].reg == reg)
+			break;
+	}
+
+	if (i >= 0) {
+		orig = batch->regs[i].val;
+	}
+	else {
+		batch->status = rt5682s_reg_raw_read(batch->pDevice, reg, &orig);
+		if (!NT_SUCCESS(batch->status))
+			return;
+	}
+
+	tmp = (orig & ~mask) | (val & mask);
+	if (tmp != orig)
+		rt5682s_batch_queue(batch, reg, tmp);
+}
+
+static void rt5682s_batch_block_update(struct rt5682s_batch* batch, uint16_t reg, int count,
+	const uint16_t* masks, const uint16_t* vals)
+{
+	rt5682s_batch_flush(batch);
+	if (NT_SUCCESS(batch->status))
+		batch->status = rt5682s_reg_raw_block_update(batch->pDevice, reg, count, masks, vals);
+}
+
+//
+// A settle window starts timing a delay without sleeping. Writes queued
+// inside the window must not depend on the block that is settling; they go
+// out while it settles, and the window end only sleeps for what is left.
+// Both ends are ordering barriers. RegCacheLock is released for the sleep
+// unless holdLock is set, which keeps a half switched codec from anyone
+// else for the short PLL lock times.
+//
+static void rt5682s_batch_settle_begin(struct rt5682s_batch* batch, int ms)
+{
+	rt5682s_batch_flush(batch);
+	batch->settleEnd = KeQueryInterruptTime() + (ULONGLONG)ms * 10000;
+}
+
+static void rt5682s_batch_settle_end(struct rt5682s_batch* batch, BOOLEAN holdLock)
+{
+	rt5682s_batch_flush(batch);
+
+	LONGLONG remaining = (LONGLONG)(batch->settleEnd - KeQueryInterruptTime());
+	batch->settleEnd = 0;
+	if (remaining <= 0)
+		return;
+
+	if (!holdLock)
+		rt5682s_reg_unlock(batch->pDevice);
+
+	LONGLONG start = rt5682s_prof_now();
+	LARGE_INTEGER WaitInterval;
+	WaitInterval.QuadPart = -remaining;
+	KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+	rt5682s_prof_event(batch->pDevice, ProfEventDelay, 0, (uint16_t)(remaining / 10000), start);
+
+	if (!holdLock)
+		rt5682s_reg_lock(batch->pDevice);
+}
+
+//Delays are ordering barriers, nothing queued before one is sent after it
+static void rt5682s_batch_delay(struct rt5682s_batch* batch, int ms)
+{
+	rt5682s_batch_settle_begin(batch, ms);
+	rt5682s_batch_settle_end(batch, FALSE);
+}
+
+static NTSTATUS rt5682s_batch_commit(struct rt5682s_batch* batch)
+{
+	rt5682s_batch_flush(batch);
+	rt5682s_reg_unlock(batch->pDevice);
+	return batch->status;
+}
+
+static Platform GetPlatform() {
+	int cpuinfo[4];
+	__cpuidex(cpuinfo, 0, 0);
+
+	int temp = cpuinfo[2];
+	cpuinfo[2] = cpuinfo[3];
+	cpuinfo[3] = temp;
+
+	char vendorName[13];
+	RtlZeroMemory(vendorName, 13);
+	memcpy(vendorName, &cpuinfo[1], 12);
+
+	__cpuidex(cpuinfo, 1, 0);
+
+	UINT16 family = (cpuinfo[0] >> 8) & 0xF;
+	UINT8 model = (cpuinfo[0] >> 4) & 0xF;
+	UINT8 stepping = cpuinfo[0] & 0xF;
+	if (family == 0xF || family == 0x6) {
+		model += (((cpuinfo[0] >> 16) & 0xF) << 4);
+	}
+	if (family == 0xF) {
+		family += (cpuinfo[0] >> 20) & 0xFF;
+	}
+
+	if (strcmp(vendorName, "AuthenticAMD") == 0) {
+		if (family == 25 && model == 80)
+			return PlatformRyzenCezanne;
+		else if (family == 23 && (model == 32 || model == 24))
+			return PlatformRyzenDali; //Picasso is model 24 but add that too
+		else
+			return PlatformRyzenMendocino; //family 23 for Mendocino (model 160)
+	} else if (strcmp(vendorName, "GenuineIntel") == 0) {
+		if (model == 122 || model == 92) //92 = Apollo Lake but keep for compatibility
+			return PlatformGeminiLake;
+		else
+			return PlatformTigerLake;
+	}
+	return PlatformNone;
+}
+
+//
+// Register polls sleep briefly, backing off exponentially up to the call
+// site's old fixed interval. Each device learns how long every site's
+// condition really takes, and later polls sleep straight to just before
+// that time. The learned state is updated under RegCacheLock.
+//
+static const struct rt5682s_poll_site {
+	const char* name;
+	UINT32 intervalMs;	//Longest sleep between reads
+	UINT32 timeoutMs;
+} rt5682s_poll_sites[RT5682S_POLL_SITE_COUNT] = {
+	[RT5682S_POLL_CALIB] = { "HP calibration", 10, 600 },
+	[RT5682S_POLL_JACK_TYPE] = { "Jack type", 15, 750 },
+};
+
+static void rt5682s_poll_done(PRTEK_CONTEXT pDevice, struct rt5682s_poll_stats* stats,
+	BOOLEAN timedOut, UINT32 elapsedMs)
+{
+	rt5682s_reg_lock(pDevice);
+	if (timedOut) {
+		stats->timeouts++;
+	}
+	else {
+		stats->estimateMs = stats->count ? (stats->estimateMs * 3 + elapsedMs) / 4 : elapsedMs;
+		stats->count++;
+		stats->totalMs += elapsedMs;
+		if (elapsedMs > stats->maxMs)
+			stats->maxMs = elapsedMs;
+	}
+	rt5682s_reg_unlock(pDevice);
+}
+
+static NTSTATUS rt5682s_poll_reg(PRTEK_CONTEXT pDevice, int siteId,
+	uint16_t reg, uint16_t mask, uint16_t value, BOOLEAN equal, uint16_t* data)
+{
+	const struct rt5682s_poll_site* site = &rt5682s_poll_sites[siteId];
+	struct rt5682s_poll_stats* stats = &pDevice->PollStats[siteId];
+	ULONGLONG start = KeQueryInterruptTime();
+	UINT32 sleepMs = max(stats->estimateMs * 3 / 4, 1);
+	BOOLEAN first = TRUE;
+	UINT32 elapsedMs;
+	uint16_t val = 0;
+
+	for (;;) {
+		NTSTATUS status = rt5682s_reg_read(pDevice, reg, &val);
+		elapsedMs = (UINT32)((KeQueryInterruptTime() - start) / 10000);
+
+		if (NT_SUCCESS(status) && (((val & mask) == value) == equal)) {
+			rt5682s_poll_done(pDevice, stats, FALSE, elapsedMs);
+			*data = val;
+			return STATUS_SUCCESS;
+		}
+
+		if (elapsedMs >= site->timeoutMs)
+			break;
+
+		UINT32 waitMs = first ? sleepMs : min(sleepMs, site->intervalMs);
+		waitMs = min(waitMs, site->timeoutMs - elapsedMs);
+
+		LONGLONG sleepStart = rt5682s_prof_now();
+		LARGE_INTEGER WaitInterval;
+		WaitInterval.QuadPart = -10 * 1000 * (LONGLONG)waitMs;
+		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+		rt5682s_prof_event(pDevice, ProfEventPoll, reg, val, sleepStart);
+
+		//Past the learned settle time the backoff restarts from 1 ms
+		sleepMs = first ? 1 : sleepMs * 2;
+		first = FALSE;
+	}
+
+	rt5682s_poll_done(pDevice, stats, TRUE, elapsedMs);
+	*data = val;
+	return STATUS_IO_TIMEOUT;
+}
+
+static void rt5682s_poll_report(PRTEK_CONTEXT pDevice)
+{
+	for (int i = 0; i < RT5682S_POLL_SITE_COUNT; i++) {
+		struct rt5682s_poll_stats* stats = &pDevice->PollStats[i];
+		if (!stats->count && !stats->timeouts)
+			continue;
+
+		RtekStatPrint("%s poll: %u done, %u timed out, avg %u ms, max %u ms, estimate %u ms\n",
+			rt5682s_poll_sites[i].name, stats->count, stats->timeouts,
+			stats->count ? (UINT32)(stats->totalMs / stats->count) : 0,
+			stats->maxMs, stats->estimateMs);
+	}
+}
+
+//Reads the calibration status block, FALSE while a calibration is still running
+static BOOLEAN rt5682s_read_calib_state(_In_ PRTEK_CONTEXT pDevice, UINT16 *state)
+{
+	if (!NT_SUCCESS(rt5682s_reg_block_read(pDevice, RT5682S_HP_CALIB_ST_1, state, RT5682S_CALIB_ST_COUNT)))
+		return FALSE;
+
+	return !(state[0] & 0x8000);
+}
+
+//The codec still reports the result of the last successful calibration
+static BOOLEAN rt5682s_calib_kept(_In_ PRTEK_CONTEXT pDevice)
+{
+	UINT16 calibState[RT5682S_CALIB_ST_COUNT];
+
+	return pDevice->CalibSaved && rt5682s_read_calib_state(pDevice, calibState) &&
+		RtlCompareMemory(calibState, pDevice->CalibState, sizeof(calibState)) == sizeof(calibState);
+}
+
+//
+// Calibration results live in read-only status registers, so a saved result
+// cannot be written back to a codec that lost it. It is kept in the device
+// Settings key and compared against what the codec reports after reset.
+//
+static NTSTATUS rt5682s_open_settings_key(_In_ PRTEK_CONTEXT pDevice, ACCESS_MASK access, WDFKEY* settingsKey)
+{
+	WDFKEY deviceKey;
+	DECLARE_CONST_UNICODE_STRING(settingsName, L"Settings");
+
+	NTSTATUS status = WdfDeviceOpenRegistryKey(pDevice->FxDevice, PLUGPLAY_REGKEY_DEVICE,
+		access, WDF_NO_OBJECT_ATTRIBUTES, &deviceKey);
+	if (!NT_SUCCESS(status))
+		return status;
+
+	status = WdfRegistryCreateKey(deviceKey, &settingsName, access, REG_OPTION_NON_VOLATILE,
+		NULL, WDF_NO_OBJECT_ATTRIBUTES, settingsKey);
+	WdfRegistryClose(deviceKey);
+	return status;
+}
+
+static void rt5682s_load_calib_settings(_In_ PRTEK_CONTEXT pDevice)
+{
+	WDFKEY key;
+	DECLARE_CONST_UNICODE_STRING(policyName, L"HpCalibrationPolicy");
+	DECLARE_CONST_UNICODE_STRING(stateName, L"HpCalibrationState");
+
+	pDevice->HpCalibPolicy = CalibPolicyAlways;
+	pDevice->CalibSaved = FALSE;
+
+	if (!NT_SUCCESS(rt5682s_open_settings_key(pDevice, KEY_READ, &key)))
+		return;
+
+	ULONG policy;
+	if (NT_SUCCESS(WdfRegistryQueryULong(key, &policyName, &policy)) && policy == CalibPolicyReuse)
+		pDevice->HpCalibPolicy = CalibPolicyReuse;
+
+	ULONG length = 0, type = 0;
+	NTSTATUS status = WdfRegistryQueryValue(key, &stateName, sizeof(pDevice->CalibState),
+		pDevice->CalibState, &length, &type);
+	pDevice->CalibSaved = NT_SUCCESS(status) && type == REG_BINARY && length == sizeof(pDevice->CalibState);
+
+	WdfRegistryClose(key);
+}
+
+static void rt5682s_load_boot_settings(_In_ PRTEK_CONTEXT pDevice)
+{
+	WDFKEY key;
+	DECLARE_CONST_UNICODE_STRING(asyncName, L"AsyncBringUp");
+	DECLARE_CONST_UNICODE_STRING(pllErrName, L"PllMaxErrorPpb");
+	DECLARE_CONST_UNICODE_STRING(seqName, L"SpbMaxSequenceTransfers");
+
+	pDevice->AsyncBringUp = FALSE;
+	pDevice->PllMaxErrPpb = 0;
+	pDevice->I2CContext.MaxSequenceTransfers = 0;
+
+	if (!NT_SUCCESS(rt5682s_open_settings_key(pDevice, KEY_READ, &key)))
+		return;
+
+	ULONG async;
+	if (NT_SUCCESS(WdfRegistryQueryULong(key, &asyncName, &async)))
+		pDevice->AsyncBringUp = async != 0;
+
+	ULONG pllErr;
+	if (NT_SUCCESS(WdfRegistryQueryULong(key, &pllErrName, &pllErr)))
+		pDevice->PllMaxErrPpb = min(pllErr, RT5682S_PLL_MAX_ERR_PPB);
+
+	//Bounded by SpbTargetInitialize
+	ULONG maxTransfers;
+	if (NT_SUCCESS(WdfRegistryQueryULong(key, &seqName, &maxTransfers)))
+		pDevice->I2CContext.MaxSequenceTransfers = maxTransfers;
+
+	WdfRegistryClose(key);
+}
+
+static void rt5682s_store_calib_state(_In_ PRTEK_CONTEXT pDevice)
+{
+	WDFKEY key;
+	DECLARE_CONST_UNICODE_STRING(stateName, L"HpCalibrationState");
+
+	if (!NT_SUCCESS(rt5682s_open_settings_key(pDevice, KEY_WRITE, &key)))
+		return;
+
+	WdfRegistryAssignValue(key, &stateName, REG_BINARY, sizeof(pDevice->CalibState), pDevice->CalibState);
+	WdfRegistryClose(key);
+}
+
+//
+// Snapshot the register cache after a full boot. Only registers that differ
+// from their post-reset default are kept, everything else is implied.
+//
+static void rt5682s_save_reg_image(_In_ PRTEK_CONTEXT pDevice)
+{
+	rt5682s_reg_lock(pDevice);
+
+	RtlZeroMemory(pDevice->RegImageValid, sizeof(pDevice->RegImageValid));
+	for (int slot = 0; slot < RT5682S_REG_COUNT; slot++) {
+		const struct rt5682s_reg_attr* attr = &rt5682s_reg_attrs[slot];
+		if (attr->flags & (RT5682S_REG_VOL | RT5682S_REG_WC))
+			continue;
+		if (!(pDevice->RegCacheValid[slot / 32] & (1UL << (slot % 32))))
+			continue;
+		if ((attr->flags & RT5682S_REG_DEF) && pDevice->RegCache[slot] == attr->def)
+			continue;
+
+		pDevice->RegImage[slot] = pDevice->RegCache[slot];
+		pDevice->RegImageValid[slot / 32] |= (1UL << (slot % 32));
+	}
+
+	rt5682s_reg_unlock(pDevice);
+}
+
+//
+// Full boots leave a signature in the DUMMY_1..3 scratch registers, which
+// reset clears: a magic, a boot generation and a hash of the register
+// image. A codec that still carries it, and whose key registers still
+// hold the value last written to them, kept its power and skips reset and
+// calibration. The signature is accessed one register at a time so it
+// does not depend on the block access probe.
+//
+#define RT5682S_SIGNATURE_MAGIC 0x5682
+
+static const UINT16 rt5682s_resume_keys[] = {
+	RT5682S_I2C_CTRL,
+	RT5682S_PWR_ANLG_1,
+	RT5682S_GLB_CLK,
+	RT5682S_CBJ_CTRL_1,
+};
+
+static UINT16 rt5682s_reg_image_hash(_In_ PRTEK_CONTEXT pDevice)
+{
+	UINT32 hash = 0;
+
+	for (int slot = 0; slot < RT5682S_REG_COUNT; slot++) {
+		if (pDevice->RegImageValid[slot / 32] & (1UL << (slot % 32)))
+			hash = (hash * 31) ^ ((UINT32)slot << 16 | pDevice->RegImage[slot]);
+	}
+	return (UINT16)(hash ^ (hash >> 16));
+}
+
+static NTSTATUS rt5682s_write_signature(_In_ PRTEK_CONTEXT pDevice)
+{
+	UINT16 generation = pDevice->ResumeSignature[1] + 1;
+
+	pDevice->ResumeSignature[0] = RT5682S_SIGNATURE_MAGIC;
+	pDevice->ResumeSignature[1] = generation ? generation : 1;
+	pDevice->ResumeSignature[2] = rt5682s_reg_image_hash(pDevice);
+
+	NTSTATUS status = STATUS_SUCCESS;
+	rt5682s_reg_lock(pDevice);
+	for (int i = 0; i < RT5682S_SIGNATURE_COUNT && NT_SUCCESS(status); i++) {
+		status = rt5682s_reg_raw_write(pDevice, RT5682S_DUMMY_1 + i, pDevice->ResumeSignature[i]);
+	}
+	rt5682s_reg_unlock(pDevice);
+	return status;
+}
+
+static BOOLEAN rt5682s_check_signature(_In_ PRTEK_CONTEXT pDevice)
+{
+	UINT16 signature[RT5682S_SIGNATURE_COUNT];
+	BOOLEAN kept = FALSE;
+
+	rt5682s_reg_lock(pDevice);
+
+	for (int i = 0; i < RT5682S_SIGNATURE_COUNT; i++) {
+		if (!NT_SUCCESS(rt5682s_reg_raw_read(pDevice, RT5682S_DUMMY_1 + i, &signature[i])))
+			goto exit;
+	}
+	if (RtlCompareMemory(signature, pDevice->ResumeSignature, sizeof(signature)) != sizeof(signature))
+		goto exit;
+
+	//Key registers are read from the codec and checked against the last write
+	for (int i = 0; i < sizeof(rt5682s_resume_keys) / sizeof(rt5682s_resume_keys[0]); i++) {
+		int slot = rt5682s_reg_slot(rt5682s_resume_keys[i]);
+		BOOLEAN known;
+		UINT16 expected, val;
+
+		known = rt5682s_cache_get(pDevice, rt5682s_resume_keys[i], &expected);
+		if (!known && (pDevice->RegImageValid[slot / 32] & (1UL << (slot % 32)))) {
+			expected = pDevice->RegImage[slot];
+			known = TRUE;
+		}
+
+		rt5682s_cache_drop(pDevice, rt5682s_resume_keys[i]);
+		if (!NT_SUCCESS(rt5682s_reg_raw_read(pDevice, rt5682s_resume_keys[i], &val)))
+			goto exit;
+		if (known && expected != val)
+			goto exit;
+	}
+	kept = TRUE;
+
+exit:
+	rt5682s_reg_unlock(pDevice);
+	return kept;
+}
+
+//
+// Init programs are flat op arrays run inside one register batch, so runs
+// of writes and updates go out as SPB sequences. RT5682S_OP_IF skips the
+// next arg ops unless the platform is in its val mask.
+//
+// Ops run strictly in program order and every write that changes a
+// register goes out, so repeated writes of one register keep their pulses.
+// Only writes of the value the register already holds are left out.
+//
+enum rt5682s_opcode {
+	RT5682S_OP_WRITE = 1,	//reg = val
+	RT5682S_OP_UPDATE,	//reg = (reg & ~mask) | (val & mask)
+	RT5682S_OP_DELAY,	//Sleep val ms
+	RT5682S_OP_POLL,	//Wait for (reg & mask) == val using poll site arg
+	RT5682S_OP_IF,		//Run the next arg ops only on platforms in val
+};
+
+#include <pshpack1.h>
+struct rt5682s_op {
+	UINT8 code;
+	UINT8 arg;
+	UINT16 reg;
+	UINT16 mask;
+	UINT16 val;
+};
+#include <poppack.h>
+
+#define OP_WRITE(reg, val)		{ RT5682S_OP_WRITE, 0, reg, 0xffff, val }
+#define OP_UPDATE(reg, mask, val)	{ RT5682S_OP_UPDATE, 0, reg, mask, val }
+#define OP_DELAY(ms)			{ RT5682S_OP_DELAY, 0, 0, 0, ms }
+#define OP_POLL(site, reg, mask, val)	{ RT5682S_OP_POLL, site, reg, mask, val }
+#define OP_IF(platforms, count)		{ RT5682S_OP_IF, count, 0, 0, platforms }
+#define OP_PLATFORM(p)			(1 << (p))
+
+#define OP_MENDOCINO	OP_PLATFORM(PlatformRyzenMendocino)
+#define OP_CEZANNE	(OP_PLATFORM(PlatformRyzenCezanne) | OP_PLATFORM(PlatformRyzenDali))
+#define OP_DEFAULT	(0xffff & ~(OP_MENDOCINO | OP_CEZANNE))
+
+#define RT5682S_PROGRAM_LEN(ops) (sizeof(ops) / sizeof((ops)[0]))
+#define RT5682S_TUNING_MAX_OPS 256
+#define RT5682S_TUNING_MAX_DELAY 100
+
+//
+// The full boot is the patch program, calibration, then the settings
+// program. Registers the platforms set differently are written once, at
+// the first position the generic sequence wrote them, with the platform's
+// final value, so every platform writes each register once. Platform
+// values used to follow the boot reclock, which only does anything on
+// Tiger Lake, the one platform without its own values.
+//
+static const struct rt5682s_op rt5682s_init_patch[] = {
+	OP_WRITE(RT5682S_I2C_CTRL, 0x0007),
+	OP_WRITE(RT5682S_DIG_IN_CTRL_1, 0x0000),
+	OP_WRITE(RT5682S_CHOP_DAC_2, 0x2020),
+	OP_WRITE(RT5682S_VREF_REC_OP_FB_CAP_CTRL_2, 0x0101),
+	OP_WRITE(RT5682S_VREF_REC_OP_FB_CAP_CTRL_1, 0x80c0),
+	OP_WRITE(RT5682S_HP_CALIB_CTRL_9, 0x0002),
+	OP_WRITE(RT5682S_DEPOP_1, 0x0000),
+	OP_WRITE(RT5682S_HP_CHARGE_PUMP_2, 0x3c15),
+	//The patch value 0xfefe was overwritten after calibration, which runs with no DAC data
+	OP_IF(OP_DEFAULT, 1),
+	OP_WRITE(RT5682S_DAC1_DIG_VOL, 0xecec),
+	OP_IF(OP_MENDOCINO, 1),
+	OP_WRITE(RT5682S_DAC1_DIG_VOL, 0xeaea),
+	OP_IF(OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_DAC1_DIG_VOL, 0xfcfc),
+	OP_WRITE(RT5682S_SAR_IL_CMD_2, 0xac00),
+	OP_WRITE(RT5682S_SAR_IL_CMD_3, 0x024c),
+	OP_WRITE(RT5682S_CBJ_CTRL_6, 0x0804),
+
+	OP_UPDATE(RT5682S_PWR_DIG_2, RT5682S_DLDO_I_LIMIT_MASK, RT5682S_DLDO_I_LIMIT_DIS),
+	OP_DELAY(20),
+};
+
+static const struct rt5682s_op rt5682s_init_settings[] = {
+	OP_UPDATE(RT5682S_MICBIAS_2, RT5682S_PWR_CLK25M_MASK | RT5682S_PWR_CLK1M_MASK,
+		RT5682S_PWR_CLK25M_PD | RT5682S_PWR_CLK1M_PU),
+	OP_UPDATE(RT5682S_PWR_ANLG_1, RT5682S_PWR_BG, RT5682S_PWR_BG),
+	OP_UPDATE(RT5682S_HP_LOGIC_CTRL_2, RT5682S_HP_SIG_SRC_MASK, RT5682S_HP_SIG_SRC_1BIT_CTL),
+	OP_UPDATE(RT5682S_HP_CHARGE_PUMP_2, RT5682S_PM_HP_MASK, RT5682S_PM_HP_HV),
+	OP_UPDATE(RT5682S_HP_AMP_DET_CTL_1, RT5682S_CP_SW_SIZE_MASK, RT5682S_CP_SW_SIZE_L | RT5682S_CP_SW_SIZE_S),
+
+	//Set Clocks (AlderLake), reclocking sets PLL_CTRL_3/4/7 and TDM_TCON_CTRL_1
+	OP_WRITE(RT5682S_RC_CLK_CTRL, 0xc009),
+	OP_WRITE(RT5682S_I2S2_M_CLK_CTRL_1, 0x0020),
+	OP_WRITE(RT5682S_GLB_CLK, 0x0000), //Reclocking should set 0x4000
+	OP_IF(OP_DEFAULT | OP_MENDOCINO, 1),
+	OP_WRITE(RT5682S_ADDA_CLK_1, 0x1021),
+	OP_IF(OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_ADDA_CLK_1, 0x1121),
+
+	//Set clk
+	OP_WRITE(RT5682S_PLL_TRACK_2, 0x0100),
+
+	//Update more defaults
+	OP_IF(OP_DEFAULT, 1),
+	OP_WRITE(RT5682S_STO1_ADC_DIG_VOL, 0x2faf),
+	OP_IF(OP_MENDOCINO | OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_STO1_ADC_DIG_VOL, 0x6565),
+	OP_IF(OP_DEFAULT, 1),
+	OP_WRITE(RT5682S_REC_MIXER, 0x1940),
+	OP_IF(OP_MENDOCINO | OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_REC_MIXER, 0x0d40),
+	OP_WRITE(RT5682S_I2S2_SDP, 0x4000),
+	OP_WRITE(RT5682S_PLL_TRACK_3, 0x0100),
+	OP_WRITE(RT5682S_GPIO_CTRL_1, 0x6960),
+	OP_WRITE(RT5682S_DMIC_CTRL_1, 0x0800),
+
+	//Headphone defaults
+	OP_WRITE(RT5682S_HP_CTRL_2, 0x6001),
+	OP_WRITE(RT5682S_STO1_ADC_MIXER, 0x6064),
+	OP_WRITE(RT5682S_PWR_DIG_1, 0x8dd1),
+	OP_WRITE(RT5682S_PWR_DIG_2, 0x840a),
+	OP_WRITE(RT5682S_PWR_ANLG_2, 0x8001),
+	OP_WRITE(RT5682S_PWR_ANLG_3, 0x52a1),
+	OP_WRITE(RT5682S_CLK_DET, 0x8000),
+	OP_WRITE(RT5682S_DEPOP_1, 0x7b),
+	OP_WRITE(RT5682S_BIAS_CUR_CTRL_12, 0xa82a),
+
+	//For Alder Lake
+	OP_WRITE(RT5682S_HP_CTRL_1, 0x8080),
+	OP_IF(OP_DEFAULT, 1),
+	OP_WRITE(RT5682S_STO1_DAC_MIXER, 0x2080),
+	OP_IF(OP_MENDOCINO | OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_STO1_DAC_MIXER, 0xa0a0),
+	OP_IF(OP_DEFAULT, 1),
+	OP_WRITE(RT5682S_I2S1_SDP, 0x0000), //Reclocking should set 0x2220
+	OP_IF(OP_MENDOCINO, 1),
+	OP_WRITE(RT5682S_I2S1_SDP, RT5682S_I2S_DF_PCM_A),
+	OP_IF(OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_I2S1_SDP, 0x3300),
+	OP_WRITE(RT5682S_TDM_ADDA_CTRL_1, 0x8000),
+	OP_IF(OP_DEFAULT | OP_MENDOCINO, 1),
+	OP_WRITE(RT5682S_TDM_ADDA_CTRL_2, 0x0080),
+	OP_IF(OP_CEZANNE, 1),
+	OP_WRITE(RT5682S_TDM_ADDA_CTRL_2, 0x0000),
+
+	//For Mendocino
+	OP_IF(OP_MENDOCINO, 2),
+	OP_WRITE(RT5682S_A_DAC1_MUX, 0x0311),
+	OP_UPDATE(RT5682S_TDM_TCON_CTRL_1, RT5682S_TDM_BCLK_MS1_MASK | RT5682S_TDM_DF_MASK,
+		RT5682S_TDM_BCLK_MS1_128 | RT5682S_TDM_DF_PCM_A),
+
+	//For Cezanne, 64 BCLK per frame in I2S format
+	OP_IF(OP_CEZANNE, 2),
+	OP_WRITE(RT5682S_A_DAC1_MUX, 0x0311),
+	OP_WRITE(RT5682S_TDM_TCON_CTRL_1, 0x0101),
+};
+
+//
+// Headphone offset calibration runs with the DAC path clocked but muted.
+// rt5682s_calib_done leaves every register the run touched as a finished
+// calibration does; a boot that keeps the old calibration runs only that.
+//
+static const struct rt5682s_op rt5682s_calib_run[] = {
+	OP_WRITE(RT5682S_PWR_ANLG_1, 0xaa80),
+	OP_DELAY(15),
+	OP_WRITE(RT5682S_PWR_ANLG_1, 0xfa80),
+	OP_WRITE(RT5682S_PWR_DIG_1, 0x01c0),
+	OP_WRITE(RT5682S_MICBIAS_2, 0x0380),
+	OP_WRITE(RT5682S_GLB_CLK, 0x8000),
+	OP_WRITE(RT5682S_ADDA_CLK_1, 0x1001),
+	OP_WRITE(RT5682S_CHOP_DAC_2, 0x3030),
+	OP_WRITE(RT5682S_CHOP_ADC, 0xb000),
+	OP_WRITE(RT5682S_STO1_ADC_MIXER, 0x686c),
+	OP_WRITE(RT5682S_CAL_REC, 0x5151),
+	OP_WRITE(RT5682S_HP_CALIB_CTRL_2, 0x0321),
+	OP_WRITE(RT5682S_HP_LOGIC_CTRL_2, 0x0004),
+	OP_WRITE(RT5682S_HP_CALIB_CTRL_1, 0x7c00),
+	OP_WRITE(RT5682S_HP_CALIB_CTRL_1, 0xfc00),
+	OP_POLL(RT5682S_POLL_CALIB, RT5682S_HP_CALIB_ST_1, 0x8000, 0),
+};
+
+static const struct rt5682s_op rt5682s_calib_done[] = {
+	//Kept from the run
+	OP_WRITE(RT5682S_ADDA_CLK_1, 0x1001),
+	OP_WRITE(RT5682S_CHOP_DAC_2, 0x3030),
+	OP_WRITE(RT5682S_CHOP_ADC, 0xb000),
+	OP_WRITE(RT5682S_HP_LOGIC_CTRL_2, 0x0004),
+
+	//Restored after it
+	OP_WRITE(RT5682S_MICBIAS_2, 0x0180),
+	OP_WRITE(RT5682S_CAL_REC, 0x5859),
+	OP_WRITE(RT5682S_STO1_ADC_MIXER, 0xc0c4),
+	OP_WRITE(RT5682S_HP_CALIB_CTRL_2, 0x0320),
+	OP_WRITE(RT5682S_PWR_DIG_1, 0x00c0),
+	OP_WRITE(RT5682S_PWR_ANLG_1, 0x0800),
+	OP_WRITE(RT5682S_GLB_CLK, 0x0000),
+};
+
+//Register a batch or the cache last saw, FALSE if neither knows it
+static BOOLEAN rt5682s_batch_peek(struct rt5682s_batch* batch, uint16_t reg, uint16_t* val)
+{
+	for (int i = batch->count - 1; i >= 0; i--) {
+		if (batch->regs[i].reg == reg) {
+			*val = batch->regs[i].val;
+			return TRUE;
+		}
+	}
+	return rt5682s_cache_get(batch->pDevice, reg, val);
+}
+
+static NTSTATUS rt5682s_run_program(PRTEK_CONTEXT pDevice, Platform platform, const char* name,
+	const struct rt5682s_op* ops, int count)
+{
+	struct rt5682s_batch batch;
+	ULONGLONG start = KeQueryInterruptTime();
+
+	rt5682s_batch_begin(pDevice, &batch);
+	batch.merge = FALSE;
+
+	for (int pc = 0; pc < count && NT_SUCCESS(batch.status); pc++) {
+		const struct rt5682s_op* op = &ops[pc];
+		ULONGLONG opStart = KeQueryInterruptTime();
+		uint16_t cur;
+
+		switch (op->code) {
+		case RT5682S_OP_WRITE:
+			if (!(rt5682s_reg_flags(op->reg) & RT5682S_REG_WC) &&
+				rt5682s_batch_peek(&batch, op->reg, &cur) && cur == op->val)
+				break;
+			rt5682s_batch_write(&batch, op->reg, op->val);
+			break;
+		case RT5682S_OP_UPDATE:
+			rt5682s_batch_update(&batch, op->reg, op->mask, op->val);
+			break;
+		case RT5682S_OP_DELAY:
+			rt5682s_batch_delay(&batch, op->val);
+			break;
+		case RT5682S_OP_POLL:
+			rt5682s_batch_flush(&batch);
+			if (!NT_SUCCESS(batch.status))
+				break;
+			if (op->arg >= RT5682S_POLL_SITE_COUNT) {
+				batch.status = STATUS_INVALID_PARAMETER;
+				break;
+			}
+			{
+				uint16_t val;
+				rt5682s_reg_unlock(pDevice);
+				batch.status = rt5682s_poll_reg(pDevice, op->arg,
+					op->reg, op->mask, op->val, TRUE, &val);
+				rt5682s_reg_lock(pDevice);
+			}
+			break;
+		case RT5682S_OP_IF:
+			if (!(op->val & OP_PLATFORM(platform)))
+				pc += op->arg;
+			break;
+		default:
+			batch.status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		if (op->code == RT5682S_OP_DELAY || op->code == RT5682S_OP_POLL) {
+			RtekPrint(DEBUG_LEVEL_VERBOSE, DBG_PNP, "%s op %d took %llu us\n",
+				name, pc, (KeQueryInterruptTime() - opStart) / 10);
+		}
 	}
 
-	tmp = orig & ~mask;
-	tmp |= val & mask;
+	NTSTATUS status = rt5682s_batch_commit(&batch);
 
-	if (tmp != orig) {
-		status = rt5682s_reg_write(pDevice, reg, tmp);
-	}
+	RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "%s program took %llu us\n",
+		name, (KeQueryInterruptTime() - start) / 10);
 	return status;
 }
 
-static NTSTATUS rt5682s_reg_burstWrite(PRTEK_CONTEXT pDevice, struct reg* regs, int regCount) {
-	NTSTATUS status = STATUS_NO_MEMORY;
-	for (int i = 0; i < regCount; i++) {
-		struct reg* regToSet = &regs[i];
-		status = rt5682s_reg_write(pDevice, regToSet->reg, regToSet->val);
-		if (!NT_SUCCESS(status)) {
-			return status;
-		}
+static NTSTATUS rt5682s_calibrate(_In_  PRTEK_CONTEXT  pDevice)
+{
+	NTSTATUS status = rt5682s_run_program(pDevice, PlatformNone, "calibration",
+		rt5682s_calib_run, RT5682S_PROGRAM_LEN(rt5682s_calib_run));
+	if (!NT_SUCCESS(status)) {
+		DbgPrint("HP Calibration Failure\n");
 	}
-	return status;
+
+	/* restore settings */
+	NTSTATUS doneStatus = rt5682s_run_program(pDevice, PlatformNone, "calibration done",
+		rt5682s_calib_done, RT5682S_PROGRAM_LEN(rt5682s_calib_done));
+	return NT_SUCCESS(status) ? doneStatus : status;
 }
 
-static Platform GetPlatform() {
-	int cpuinfo[4];
-	__cpuidex(cpuinfo, 0, 0);
+//Leave the registers rt5682s_calibrate touches as it would have left them
+static NTSTATUS rt5682s_skip_calibrate(_In_ PRTEK_CONTEXT pDevice)
+{
+	return rt5682s_run_program(pDevice, PlatformNone, "calibration done",
+		rt5682s_calib_done, RT5682S_PROGRAM_LEN(rt5682s_calib_done));
+}
 
-	int temp = cpuinfo[2];
-	cpuinfo[2] = cpuinfo[3];
-	cpuinfo[3] = temp;
+//
+// Settings\InitTuning holds an optional op array run at the end of every
+// full boot. Only writes, updates, delays and platform branches of cached
+// registers are accepted.
+//
+static void rt5682s_load_init_tuning(_In_ PRTEK_CONTEXT pDevice)
+{
+	WDFKEY key;
+	WDFMEMORY memory;
+	DECLARE_CONST_UNICODE_STRING(tuningName, L"InitTuning");
 
-	char vendorName[13];
-	RtlZeroMemory(vendorName, 13);
-	memcpy(vendorName, &cpuinfo[1], 12);
+	if (!NT_SUCCESS(rt5682s_open_settings_key(pDevice, KEY_READ, &key)))
+		return;
 
-	__cpuidex(cpuinfo, 1, 0);
+	ULONG type = 0;
+	NTSTATUS status = WdfRegistryQueryMemory(key, &tuningName, NonPagedPool,
+		WDF_NO_OBJECT_ATTRIBUTES, &memory, &type);
+	WdfRegistryClose(key);
+	if (!NT_SUCCESS(status))
+		return;
 
-	UINT16 family = (cpuinfo[0] >> 8) & 0xF;
-	UINT8 model = (cpuinfo[0] >> 4) & 0xF;
-	UINT8 stepping = cpuinfo[0] & 0xF;
-	if (family == 0xF || family == 0x6) {
-		model += (((cpuinfo[0] >> 16) & 0xF) << 4);
+	size_t length;
+	const struct rt5682s_op* ops = WdfMemoryGetBuffer(memory, &length);
+	int count = (int)(length / sizeof(struct rt5682s_op));
+	BOOLEAN valid = type == REG_BINARY && length % sizeof(struct rt5682s_op) == 0 &&
+		count > 0 && count <= RT5682S_TUNING_MAX_OPS;
+
+	for (int pc = 0; valid && pc < count; pc++) {
+		const struct rt5682s_op* op = &ops[pc];
+		switch (op->code) {
+		case RT5682S_OP_WRITE:
+		case RT5682S_OP_UPDATE:
+			valid = rt5682s_reg_slot(op->reg) >= 0 &&
+				!(rt5682s_reg_flags(op->reg) & (RT5682S_REG_VOL | RT5682S_REG_WC)) &&
+				op->reg != RT5682S_RESET;
+			break;
+		case RT5682S_OP_DELAY:
+			valid = op->val <= RT5682S_TUNING_MAX_DELAY;
+			break;
+		case RT5682S_OP_IF:
+			valid = pc + op->arg < count;
+			break;
+		default:
+			valid = FALSE;
+			break;
+		}
 	}
-	if (family == 0xF) {
-		family += (cpuinfo[0] >> 20) & 0xFF;
+
+	if (valid) {
+		pDevice->TuningOps = ExAllocatePoolWithTag(NonPagedPool, length, RT5682_POOL_TAG);
+		if (pDevice->TuningOps) {
+			RtlCopyMemory(pDevice->TuningOps, ops, length);
+			pDevice->TuningOpCount = count;
+		}
+	}
+	else {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Ignoring invalid InitTuning program\n");
 	}
 
-	if (strcmp(vendorName, "AuthenticAMD") == 0) {
-		if (family == 25 && model == 80)
-			return PlatformRyzenCezanne;
-		else if (family == 23 && (model == 32 || model == 24))
-			return PlatformRyzenDali; //Picasso is model 24 but add that too
-		else
-			return PlatformRyzenMendocino; //family 23 for Mendocino (model 160)
-	} else if (strcmp(vendorName, "GenuineIntel") == 0) {
-		if (model == 122 || model == 92) //92 = Apollo Lake but keep for compatibility
-			return PlatformGeminiLake;
-		else
-			return PlatformTigerLake;
+	WdfObjectDelete(memory);
+}
+
+static void rt5682s_free_init_tuning(_In_ PRTEK_CONTEXT pDevice)
+{
+	if (pDevice->TuningOps) {
+		ExFreePoolWithTag(pDevice->TuningOps, RT5682_POOL_TAG);
+		pDevice->TuningOps = NULL;
+		pDevice->TuningOpCount = 0;
 	}
-	return PlatformNone;
 }
 
-static void rt5682s_calibrate(_In_  PRTEK_CONTEXT  pDevice)
+#if RT5682S_PROFILE
+static const char* const rt5682s_prof_phase_names[PROFILE_PHASE_COUNT] = {
+	"reset", "patch", "calibration", "clocks", "platform", "jack", "resume"
+};
+
+static const char* const rt5682s_prof_event_names[ProfEventCount] = {
+	"write", "read", "block write", "block read", "burst", "delay", "poll"
+};
+#endif
+
+static UINT32 rt5682s_prof_us(PRTEK_CONTEXT pDevice, LONGLONG ticks)
 {
-	int count;
-	UINT16 value;
+#if RT5682S_PROFILE
+	return (UINT32)(ticks * 1000000 / pDevice->Profiler.Frequency);
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+	UNREFERENCED_PARAMETER(ticks);
+	return 0;
+#endif
+}
 
-	rt5682s_reg_write(pDevice, RT5682S_PWR_ANLG_1, 0xaa80);
-	
-	LARGE_INTEGER WaitInterval;
-	WaitInterval.QuadPart = -10 * 1000 * 15;
-	KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+//Starts profiling a codec bring up on the calling thread
+static void rt5682s_prof_begin(PRTEK_CONTEXT pDevice)
+{
+#if RT5682S_PROFILE
+	RT5682S_PROFILER* prof = &pDevice->Profiler;
+	LARGE_INTEGER freq;
+
+	prof->Start = KeQueryPerformanceCounter(&freq).QuadPart;
+	prof->Frequency = freq.QuadPart;
+	prof->First = prof->Next;
+	prof->Phase = PROFILE_PHASE_NONE;
+	RtlZeroMemory(prof->PhaseTicks, sizeof(prof->PhaseTicks));
+	RtlZeroMemory(prof->PhaseBusTicks, sizeof(prof->PhaseBusTicks));
+	RtlZeroMemory(prof->PhaseWaitTicks, sizeof(prof->PhaseWaitTicks));
+	RtlZeroMemory(prof->PhaseOps, sizeof(prof->PhaseOps));
+	prof->D0Ticks = 0;
+	prof->Thread = KeGetCurrentThread();
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+#endif
+}
 
-	rt5682s_reg_write(pDevice, RT5682S_PWR_ANLG_1, 0xfa80);
-	rt5682s_reg_write(pDevice, RT5682S_PWR_DIG_1, 0x01c0);
-	rt5682s_reg_write(pDevice, RT5682S_MICBIAS_2, 0x0380);
-	rt5682s_reg_write(pDevice, RT5682S_GLB_CLK, 0x8000);
-	rt5682s_reg_write(pDevice, RT5682S_ADDA_CLK_1, 0x1001);
-	rt5682s_reg_write(pDevice, RT5682S_CHOP_DAC_2, 0x3030);
-	rt5682s_reg_write(pDevice, RT5682S_CHOP_ADC, 0xb000);
-	rt5682s_reg_write(pDevice, RT5682S_STO1_ADC_MIXER, 0x686c);
-	rt5682s_reg_write(pDevice, RT5682S_CAL_REC, 0x5151);
-	rt5682s_reg_write(pDevice, RT5682S_HP_CALIB_CTRL_2, 0x0321);
-	rt5682s_reg_write(pDevice, RT5682S_HP_LOGIC_CTRL_2, 0x0004);
-	rt5682s_reg_write(pDevice, RT5682S_HP_CALIB_CTRL_1, 0x7c00);
-	rt5682s_reg_write(pDevice, RT5682S_HP_CALIB_CTRL_1, 0xfc00);
-
-	for (count = 0; count < 60; count++) {
-		rt5682s_reg_read(pDevice, RT5682S_HP_CALIB_ST_1, &value);
-		if (!(value & 0x8000))
-			break;
+//Marks the return from D0Entry, bring up may continue on another thread
+static void rt5682s_prof_d0(PRTEK_CONTEXT pDevice)
+{
+#if RT5682S_PROFILE
+	rt5682s_prof_phase(pDevice, PROFILE_PHASE_NONE);
+	pDevice->Profiler.D0Ticks = KeQueryPerformanceCounter(NULL).QuadPart - pDevice->Profiler.Start;
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+#endif
+}
 
-		WaitInterval.QuadPart = -10 * 1000 * 10;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+//Moves phase accounting to the thread finishing the bring up
+static void rt5682s_prof_attach(PRTEK_CONTEXT pDevice)
+{
+#if RT5682S_PROFILE
+	pDevice->Profiler.Thread = KeGetCurrentThread();
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+#endif
+}
+
+//
+// Builds the REPORTID_PROFILE summary and logs the bring up as folded
+// "boot;phase;kind us" lines for flame graph tools, followed by the timeline.
+//
+static void rt5682s_prof_end(PRTEK_CONTEXT pDevice, BOOLEAN resumed)
+{
+#if RT5682S_PROFILE
+	RT5682S_PROFILER* prof = &pDevice->Profiler;
+	Rt5682ProfileReport summary;
+
+	rt5682s_prof_phase(pDevice, PROFILE_PHASE_NONE);
+	prof->Thread = NULL;
+
+	LONG last = prof->Next;
+	LONG first = max(prof->First, last - RT5682S_PROF_RING_SIZE);
+
+	RtlZeroMemory(&summary, sizeof(summary));
+	summary.ReportID = REPORTID_PROFILE;
+	summary.Resumed = resumed;
+	summary.Events = (UINT16)min(last - prof->First, MAXUINT16);
+	summary.TotalUs = rt5682s_prof_us(pDevice, KeQueryPerformanceCounter(NULL).QuadPart - prof->Start);
+	summary.D0Us = rt5682s_prof_us(pDevice, prof->D0Ticks);
+	summary.ResumeHits = (UINT16)min(pDevice->ResumeHits, MAXUINT16);
+	summary.ResumeMisses = (UINT16)min(pDevice->ResumeMisses, MAXUINT16);
+	for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+		summary.PhaseUs[i] = rt5682s_prof_us(pDevice, prof->PhaseTicks[i]);
+		summary.PhaseBusUs[i] = rt5682s_prof_us(pDevice, prof->PhaseBusTicks[i]);
+		summary.PhaseWaitUs[i] = rt5682s_prof_us(pDevice, prof->PhaseWaitTicks[i]);
+		summary.PhaseOps[i] = (UINT16)min(prof->PhaseOps[i], MAXUINT16);
+
+		if (!prof->PhaseTicks[i])
+			continue;
+		RtekStatPrint("boot;%s;bus %u\n",
+			rt5682s_prof_phase_names[i], summary.PhaseBusUs[i]);
+		RtekStatPrint("boot;%s;wait %u\n",
+			rt5682s_prof_phase_names[i], summary.PhaseWaitUs[i]);
+		RtekStatPrint("boot;%s;cpu %u\n",
+			rt5682s_prof_phase_names[i],
+			summary.PhaseUs[i] - min(summary.PhaseUs[i], summary.PhaseBusUs[i] + summary.PhaseWaitUs[i]));
+	}
+	prof->Summary = summary;
+
+	RtekStatPrint("%s took %u us (D0 %u us), %u events\n",
+		resumed ? "Resume" : "Boot", summary.TotalUs, summary.D0Us, summary.Events);
+
+	for (LONG i = first; i < last; i++) {
+		RT5682S_PROF_EVENT* event = &prof->Ring[(ULONG)i & (RT5682S_PROF_RING_SIZE - 1)];
+		RtekStatPrint("%8u us %-11s %-11s 0x%04x 0x%04x %u us\n",
+			rt5682s_prof_us(pDevice, event->Start - prof->Start),
+			event->Phase < PROFILE_PHASE_COUNT ? rt5682s_prof_phase_names[event->Phase] : "-",
+			rt5682s_prof_event_names[event->Type],
+			event->Reg, event->Value, rt5682s_prof_us(pDevice, event->Ticks));
 	}
+#else
+	UNREFERENCED_PARAMETER(pDevice);
+	UNREFERENCED_PARAMETER(resumed);
+#endif
+}
 
-	if (count >= 60)
-		DbgPrint("HP Calibration Failure\n");
+//
+// Jack detection and reclocking touch the codec, so while an asynchronous
+// bring up is running they wait for it. Bus transfers and RegCacheLock need
+// APC_LEVEL or below, so callers above it are always turned away; the
+// audio callback then hands its reclock to a work item.
+//
+static BOOLEAN rt5682s_wait_ready(PRTEK_CONTEXT pDevice)
+{
+	if (KeGetCurrentIrql() > APC_LEVEL)
+		return FALSE;
 
-	/* restore settings */
-	rt5682s_reg_write(pDevice, RT5682S_MICBIAS_2, 0x0180);
-	rt5682s_reg_write(pDevice, RT5682S_CAL_REC, 0x5859);
-	rt5682s_reg_write(pDevice, RT5682S_STO1_ADC_MIXER, 0xc0c4);
-	rt5682s_reg_write(pDevice, RT5682S_HP_CALIB_CTRL_2, 0x0320);
-	rt5682s_reg_write(pDevice, RT5682S_PWR_DIG_1, 0x00c0);
-	rt5682s_reg_write(pDevice, RT5682S_PWR_ANLG_1, 0x0800);
-	rt5682s_reg_write(pDevice, RT5682S_GLB_CLK, 0x0000);
+	if (!KeReadStateEvent(&pDevice->CodecReady))
+		KeWaitForSingleObject(&pDevice->CodecReady, Executive, KernelMode, FALSE, NULL);
+	return NT_SUCCESS(pDevice->BootStatus);
 }
 
-NTSTATUS BOOTCODEC(
+//Resets the codec to its register defaults and checks it is an ALC5682S
+static NTSTATUS rt5682s_reset_codec(
 	_In_  PRTEK_CONTEXT  devContext
 )
 {
@@ -212,9 +1545,11 @@ NTSTATUS BOOTCODEC(
 		return status;
 	}
 
+	LONGLONG start = rt5682s_prof_now();
 	LARGE_INTEGER WaitInterval;
 	WaitInterval.QuadPart = -10 * 1000 * 50;
 	KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+	rt5682s_prof_event(devContext, ProfEventDelay, 0, 50, start);
 
 	UINT16 val;
 	status = rt5682s_reg_read(devContext, RT5682S_DEVICE_ID, &val);
@@ -227,213 +1562,201 @@ NTSTATUS BOOTCODEC(
 		return STATUS_NO_SUCH_DEVICE;
 	}
 
-	{
-		//Apply patch list
-		struct reg patch_list[] = {
-			{RT5682S_I2C_CTRL,			0x0007},
-			{RT5682S_DIG_IN_CTRL_1,			0x0000},
-			{RT5682S_CHOP_DAC_2,			0x2020},
-			{RT5682S_VREF_REC_OP_FB_CAP_CTRL_2,	0x0101},
-			{RT5682S_VREF_REC_OP_FB_CAP_CTRL_1,	0x80c0},
-			{RT5682S_HP_CALIB_CTRL_9,		0x0002},
-			{RT5682S_DEPOP_1,			0x0000},
-			{RT5682S_HP_CHARGE_PUMP_2,		0x3c15},
-			{RT5682S_DAC1_DIG_VOL,			0xfefe},
-			{RT5682S_SAR_IL_CMD_2,			0xac00},
-			{RT5682S_SAR_IL_CMD_3,			0x024c},
-			{RT5682S_CBJ_CTRL_6,			0x0804},
-		};
-		status = rt5682s_reg_burstWrite(devContext, patch_list, sizeof(patch_list) / sizeof(struct reg));
-		if (!NT_SUCCESS(status)) {
-			return status;
-		}
-	}
-
-	rt5682s_reg_update(devContext, RT5682S_PWR_DIG_2,
-		RT5682S_DLDO_I_LIMIT_MASK, RT5682S_DLDO_I_LIMIT_DIS);
-
-	WaitInterval.QuadPart = -10 * 1000 * 20;
-	KeDelayExecutionThread(KernelMode, false, &WaitInterval);
-
-	rt5682s_calibrate(devContext);
+	return STATUS_SUCCESS;
+}
 
-	rt5682s_reg_update(devContext, RT5682S_MICBIAS_2,
-		RT5682S_PWR_CLK25M_MASK | RT5682S_PWR_CLK1M_MASK,
-		RT5682S_PWR_CLK25M_PD | RT5682S_PWR_CLK1M_PU);
-	rt5682s_reg_update(devContext, RT5682S_PWR_ANLG_1,
-		RT5682S_PWR_BG, RT5682S_PWR_BG);
-	rt5682s_reg_update(devContext, RT5682S_HP_LOGIC_CTRL_2,
-		RT5682S_HP_SIG_SRC_MASK, RT5682S_HP_SIG_SRC_1BIT_CTL);
-	rt5682s_reg_update(devContext, RT5682S_HP_CHARGE_PUMP_2,
-		RT5682S_PM_HP_MASK, RT5682S_PM_HP_HV);
-	rt5682s_reg_update(devContext, RT5682S_HP_AMP_DET_CTL_1,
-		RT5682S_CP_SW_SIZE_MASK, RT5682S_CP_SW_SIZE_L | RT5682S_CP_SW_SIZE_S);
+//Reset and identify the codec, the only part of a full boot D0Entry has to wait for
+static NTSTATUS rt5682s_boot_reset(
+	_In_  PRTEK_CONTEXT  devContext
+)
+{
+	devContext->RegImageSaved = FALSE;
+	devContext->ClockApplied.valid = FALSE;
 
-	//Set Clocks (AlderLake)
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_RESET);
 
-	struct reg setClocksAlderLake[] = {
-		//{RT5682S_PLL_CTRL_3, 0x0006}, //reclocking should set these
-		//{RT5682S_PLL_CTRL_4, 0x0203},
-		//{RT5682S_PLL_CTRL_7, 0x0001},
-		{RT5682S_RC_CLK_CTRL, 0xc009},
-		{RT5682S_I2S2_M_CLK_CTRL_1, 0x0020},
+	NTSTATUS status = rt5682s_reset_codec(devContext);
+	if (NT_SUCCESS(status) && !devContext->BlockProbed) {
+		rt5682s_probe_block_access(devContext);
+	}
+	return status;
+}
 
-		{RT5682S_GLB_CLK, 0x0000}, //Reclocking should set 0x4000
+static NTSTATUS rt5682s_boot_finish(
+	_In_  PRTEK_CONTEXT  devContext
+)
+{
+	NTSTATUS status;
 
-		//set bclk1 ratio ADL
-		//{RT5682S_TDM_TCON_CTRL_1, 0x0020}, //Reclocking should set this
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_PATCH);
 
-		{RT5682S_ADDA_CLK_1, 0x1021},
-	};
+	Platform platform = GetPlatform();
 
-	status = rt5682s_reg_burstWrite(devContext, setClocksAlderLake, sizeof(setClocksAlderLake) / sizeof(struct reg));
+	status = rt5682s_run_program(devContext, platform, "patch",
+		rt5682s_init_patch, RT5682S_PROGRAM_LEN(rt5682s_init_patch));
 	if (!NT_SUCCESS(status)) {
 		return status;
 	}
 
-	struct reg finishInit2[] = {
-
-		//set clk
-		{RT5682S_PLL_TRACK_2, 0x0100},
-
-		//Update more defaults
-		{RT5682S_STO1_ADC_DIG_VOL, 0x2faf},
-		{RT5682S_REC_MIXER, 0x1940},
-		{RT5682S_I2S2_SDP, 0x4000},
-		{RT5682S_PLL_TRACK_3, 0x0100},
-		{RT5682S_GPIO_CTRL_1, 0x6960},
-		{RT5682S_DMIC_CTRL_1, 0x0800},
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_CALIBRATION);
 
-		//Headphone defaults
-		{RT5682S_HP_CTRL_2, 0x6001},
-		{RT5682S_STO1_ADC_MIXER, 0x6064},
-		{RT5682S_PWR_DIG_1, 0x8dd1},
-		{RT5682S_PWR_DIG_2, 0x840a},
-		{RT5682S_PWR_ANLG_2, 0x8001},
-		{RT5682S_PWR_ANLG_3, 0x52a1},
-		{RT5682S_CLK_DET, 0x8000},
-		{RT5682S_DEPOP_1, 0x7b},
-
-		{RT5682S_BIAS_CUR_CTRL_12, 0xa82a}
-	};
+	//Fast resume is only possible with a known good calibration
+	BOOLEAN calibrated = FALSE;
+	if (devContext->HpCalibPolicy == CalibPolicyReuse) {
+		calibrated = rt5682s_calib_kept(devContext);
+		if (calibrated) {
+			RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP,
+				"Codec kept its headphone calibration, skipping it\n");
+			calibrated = NT_SUCCESS(rt5682s_skip_calibrate(devContext));
+		}
+	}
 
-	status = rt5682s_reg_burstWrite(devContext, finishInit2, sizeof(finishInit2) / sizeof(struct reg));
-	if (!NT_SUCCESS(status)) {
-		return status;
+	if (!calibrated) {
+		calibrated = NT_SUCCESS(rt5682s_calibrate(devContext)) &&
+			rt5682s_read_calib_state(devContext, devContext->CalibState);
+		devContext->CalibSaved = calibrated;
+		if (calibrated)
+			rt5682s_store_calib_state(devContext);
 	}
 
-	struct reg setDefaultsAlderLake[] = {
-		//For Alder Lake
-		{RT5682S_HP_CTRL_1, 0x8080},
-		{RT5682S_DAC1_DIG_VOL, 0xecec},
-		{RT5682S_STO1_DAC_MIXER, 0x2080},
-		{RT5682S_I2S1_SDP, 0x0000}, //Reclocking should set 0x2220
-		{RT5682S_TDM_ADDA_CTRL_1, 0x8000},
-		{RT5682S_TDM_ADDA_CTRL_2, 0x0080}
-	};
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_CLOCKS);
 
-	status = rt5682s_reg_burstWrite(devContext, setDefaultsAlderLake, sizeof(setDefaultsAlderLake) / sizeof(struct reg));
+	status = rt5682s_run_program(devContext, platform, "init",
+		rt5682s_init_settings, RT5682S_PROGRAM_LEN(rt5682s_init_settings));
 	if (!NT_SUCCESS(status)) {
 		return status;
 	}
 
 	rt5682s_update_reclock(devContext);
 
-	Platform platform = GetPlatform();
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_PLATFORM);
 
 	if (platform == PlatformRyzenMendocino) {
-		struct reg setDefaultsMendocino[] = {
-			//For Mendocino
-			{RT5682S_DAC1_DIG_VOL, 0xeaea},
-			{RT5682S_STO1_ADC_DIG_VOL, 0x6565},
-			{RT5682S_STO1_DAC_MIXER, 0xa0a0},
-			{RT5682S_A_DAC1_MUX, 0x0311},
-			{RT5682S_REC_MIXER, 0x0d40}
-		};
-
-		status = rt5682s_reg_burstWrite(devContext, setDefaultsMendocino, sizeof(setDefaultsMendocino) / sizeof(struct reg));
-		if (!NT_SUCCESS(status)) {
-			return status;
-		}
-
-		rt5682s_reg_update(devContext, RT5682S_I2S1_SDP, RT5682S_I2S_DF_MASK,
-			RT5682S_I2S_DF_PCM_A);
-		rt5682s_reg_update(devContext, RT5682S_TDM_TCON_CTRL_1, RT5682S_TDM_BCLK_MS1_MASK | RT5682S_TDM_DF_MASK,
-			RT5682S_TDM_BCLK_MS1_128 | RT5682S_TDM_DF_PCM_A);
-
 		rt5682s_set_component_pll(devContext, RT5682S_PLL2, RT5682S_PLL_S_MCLK, 48000000, 48000 * 512);
 		rt5682s_set_tdm_slot(devContext, 3, 3, 8, 16);
 		rt5682s_set_component_sysclk(devContext, RT5682S_SCLK_S_PLL2);
 	}
 	else if (platform == PlatformRyzenCezanne || platform == PlatformRyzenDali) {
-		struct reg setDefaultsCezanne[] = {
-			//For Cezanne
-			{RT5682S_DAC1_DIG_VOL, 0xfcfc},
-			{RT5682S_STO1_ADC_DIG_VOL, 0x6565},
-			{RT5682S_STO1_DAC_MIXER, 0xa0a0},
-			{RT5682S_A_DAC1_MUX, 0x0311},
-			{RT5682S_REC_MIXER, 0x0d40},
-
-			//Set Clocks for Cezanne
-			{RT5682S_I2S1_SDP, 0x3300},
-			{RT5682S_ADDA_CLK_1, 0x1121},
-			{RT5682S_TDM_ADDA_CTRL_2, 0x0000},
-			{RT5682S_TDM_TCON_CTRL_1, 0x0101}
-		};
-
-		status = rt5682s_reg_burstWrite(devContext, setDefaultsCezanne, sizeof(setDefaultsCezanne) / sizeof(struct reg));
-		if (!NT_SUCCESS(status)) {
-			return status;
-		}
-
-		rt5682s_reg_update(devContext, RT5682S_TDM_TCON_CTRL_1, RT5682S_TDM_BCLK_MS1_MASK | RT5682S_TDM_DF_MASK,
-			RT5682S_TDM_BCLK_MS1_64 | RT5682S_TDM_DF_I2S);
-
 		rt5682s_set_component_pll(devContext, RT5682S_PLL2, RT5682S_PLL_S_MCLK, 48000000, 48000 * 512);
 		rt5682s_set_component_sysclk(devContext, RT5682S_SCLK_S_PLL2);
 	}
 
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_JACK);
+
 	//Set Jack Detect 
 
 	{
 		int btndet_delay = 16;
+		struct rt5682s_batch batch;
+
+		rt5682s_batch_begin(devContext, &batch);
 
-		rt5682s_reg_update(devContext, RT5682S_CBJ_CTRL_5,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_5,
 			RT5682S_JD_FAST_OFF_SRC_MASK, RT5682S_JD_FAST_OFF_SRC_JDH);
-		rt5682s_reg_update(devContext, RT5682S_CBJ_CTRL_2,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_2,
 			RT5682S_EXT_JD_SRC, RT5682S_EXT_JD_SRC_MANUAL);
-		rt5682s_reg_update(devContext, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_EMB_JD_MASK | RT5682S_DET_TYPE |
 			RT5682S_POL_FAST_OFF_MASK | RT5682S_MIC_CAP_MASK,
 			RT5682S_EMB_JD_EN | RT5682S_DET_TYPE |
 			RT5682S_POL_FAST_OFF_HIGH | RT5682S_MIC_CAP_HS);
-		rt5682s_reg_update(devContext, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(&batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_POW_MASK, RT5682S_SAR_POW_EN);
-		rt5682s_reg_update(devContext, RT5682S_GPIO_CTRL_1,
+		rt5682s_batch_update(&batch, RT5682S_GPIO_CTRL_1,
 			RT5682S_GP1_PIN_MASK, RT5682S_GP1_PIN_IRQ);
-		rt5682s_reg_update(devContext, RT5682S_PWR_ANLG_3,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
 			RT5682S_PWR_BGLDO, RT5682S_PWR_BGLDO);
-		rt5682s_reg_update(devContext, RT5682S_PWR_ANLG_2,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_2,
 			RT5682S_PWR_JD_MASK, RT5682S_PWR_JD_ENABLE);
-		rt5682s_reg_update(devContext, RT5682S_RC_CLK_CTRL,
+		rt5682s_batch_update(&batch, RT5682S_RC_CLK_CTRL,
 			RT5682S_POW_IRQ | RT5682S_POW_JDH, RT5682S_POW_IRQ | RT5682S_POW_JDH);
-		rt5682s_reg_update(devContext, RT5682S_IRQ_CTRL_2,
+		rt5682s_batch_update(&batch, RT5682S_IRQ_CTRL_2,
 			RT5682S_JD1_EN_MASK | RT5682S_JD1_POL_MASK,
 			RT5682S_JD1_EN | RT5682S_JD1_POL_NOR);
-		rt5682s_reg_update(devContext, RT5682S_4BTN_IL_CMD_4,
-			RT5682S_4BTN_IL_HOLD_WIN_MASK | RT5682S_4BTN_IL_CLICK_WIN_MASK,
-			(btndet_delay << RT5682S_4BTN_IL_HOLD_WIN_SFT | btndet_delay));
-		rt5682s_reg_update(devContext, RT5682S_4BTN_IL_CMD_5,
-			RT5682S_4BTN_IL_HOLD_WIN_MASK | RT5682S_4BTN_IL_CLICK_WIN_MASK,
-			(btndet_delay << RT5682S_4BTN_IL_HOLD_WIN_SFT | btndet_delay));
-		rt5682s_reg_update(devContext, RT5682S_4BTN_IL_CMD_6,
-			RT5682S_4BTN_IL_HOLD_WIN_MASK | RT5682S_4BTN_IL_CLICK_WIN_MASK,
-			(btndet_delay << RT5682S_4BTN_IL_HOLD_WIN_SFT | btndet_delay));
-		rt5682s_reg_update(devContext, RT5682S_4BTN_IL_CMD_7,
-			RT5682S_4BTN_IL_HOLD_WIN_MASK | RT5682S_4BTN_IL_CLICK_WIN_MASK,
-			(btndet_delay << RT5682S_4BTN_IL_HOLD_WIN_SFT | btndet_delay));
+		//The four button windows are consecutive registers
+		uint16_t btnMasks[4], btnVals[4];
+		for (int i = 0; i < 4; i++) {
+			btnMasks[i] = RT5682S_4BTN_IL_HOLD_WIN_MASK | RT5682S_4BTN_IL_CLICK_WIN_MASK;
+			btnVals[i] = btndet_delay << RT5682S_4BTN_IL_HOLD_WIN_SFT | btndet_delay;
+		}
+		rt5682s_batch_block_update(&batch, RT5682S_4BTN_IL_CMD_4, 4, btnMasks, btnVals);
+
+		rt5682s_batch_commit(&batch);
+	}
+
+	if (devContext->TuningOps) {
+		rt5682s_prof_phase(devContext, PROFILE_PHASE_PLATFORM);
+		status = rt5682s_run_program(devContext, platform, "tuning",
+			(const struct rt5682s_op*)devContext->TuningOps, devContext->TuningOpCount);
+		if (!NT_SUCCESS(status)) {
+			return status;
+		}
+	}
+
+	if (calibrated) {
+		rt5682s_save_reg_image(devContext);
+		calibrated = NT_SUCCESS(rt5682s_write_signature(devContext));
+	}
+	devContext->RegImageSaved = calibrated;
+
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS BOOTCODEC(
+	_In_  PRTEK_CONTEXT  devContext
+)
+{
+	NTSTATUS status = rt5682s_boot_reset(devContext);
+	if (!NT_SUCCESS(status)) {
+		return status;
+	}
+
+	return rt5682s_boot_finish(devContext);
+}
+
+//
+// Resume a codec that kept its power since the last full boot. It must
+// report the device ID and still carry the boot signature, with its key
+// registers holding what was last written to them. Its registers then
+// match the cache and nothing needs writing.
+//
+// A codec that lost its registers is not patched up from the image. The
+// PLL, clock source and analog power registers need the boot programs'
+// order and settle delays, and the reset needs calibration, so the caller
+// falls back to a full boot.
+//
+NTSTATUS RESUMECODEC(
+	_In_  PRTEK_CONTEXT  devContext
+)
+{
+	if (!devContext->RegImageSaved) {
+		return STATUS_DEVICE_NOT_READY;
+	}
+
+	rt5682s_prof_phase(devContext, PROFILE_PHASE_RESUME);
+
+	UINT16 val;
+	NTSTATUS status = rt5682s_reg_read(devContext, RT5682S_DEVICE_ID, &val);
+	if (!NT_SUCCESS(status)) {
+		return status;
+	}
+
+	if (val != DEVICE_ID) {
+		return STATUS_NO_SUCH_DEVICE;
+	}
+
+	if (!rt5682s_check_signature(devContext)) {
+		devContext->ResumeMisses++;
+		RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP,
+			"Codec registers lost (%u resumes, %u misses), full boot required\n",
+			devContext->ResumeHits, devContext->ResumeMisses);
+		return STATUS_INVALID_DEVICE_STATE;
 	}
 
+	//The clocks applied before suspend are still running
+	rt5682s_update_reclock(devContext);
+
+	devContext->ResumeHits++;
 	return STATUS_SUCCESS;
 }
 
@@ -454,22 +1777,126 @@ CSAudioRegisterEndpoint(
 	ExNotifyCallback(pDevice->CSAudioAPICallback, &arg, &CsAudioArg2); //register both in case user decides to record first
 }
 
+//Sysclk source for a reclock, the PWR_ANLG_3 bits of the PLLs it runs and how long they take to lock
+struct rt5682s_clock_plan {
+	int src;
+	const struct rt5682s_pll_config* pll;	//A preset or one of solved
+	struct rt5682s_pll_config solved[2];
+	UINT16 power;
+	UINT16 rstb;
+	int settleMs;
+};
+
+static void rt5682s_batch_pll(struct rt5682s_batch* batch, const struct rt5682s_pll_config* cfg);
+static BOOLEAN rt5682s_clock_plan(PRTEK_CONTEXT pDevice, UINT32 mclk, UINT32 sysclk,
+	struct rt5682s_clock_plan* plan);
+static NTSTATUS rt5682s_tdm_layout(unsigned int tx_mask, unsigned int rx_mask,
+	int slots, int slot_width, struct rt5682s_tdm_layout* layout);
+static void rt5682s_batch_tdm_slot(struct rt5682s_batch* batch, const struct rt5682s_tdm_layout* layout);
+static void rt5682s_batch_sysclk(struct rt5682s_batch* batch, unsigned int src);
+
+#define RT5682S_PLLA_POWER (RT5682S_PWR_LDO_PLLA | RT5682S_PWR_BIAS_PLLA | RT5682S_PWR_PLLA)
+#define RT5682S_PLLB_POWER (RT5682S_PWR_LDO_PLLB | RT5682S_PWR_BIAS_PLLB | RT5682S_PWR_PLLB)
+#define RT5682S_PLL_POWER_MASK (RT5682S_PLLA_POWER | RT5682S_PLLB_POWER | RT5682S_RSTB_PLLA | RT5682S_RSTB_PLLB)
+
+//
+// Only the parts of the clock tree that differ from the applied state are
+// reprogrammed, so a request for the current configuration costs no I2C
+// traffic. Reset invalidates the applied state and a failed step leaves it
+// invalid, which makes the next request reprogram everything.
+//
+// The switch is one register batch. New dividers are loaded with the
+// planned PLLs powered but held in reset while nothing runs from them, the
+// slot setup goes out while they lock, and only then do the clock sources
+// move over. PLLs the plan does not use are powered down. RegCacheLock is
+// held from the first write to the last, the PLL lock wait included, so
+// nobody sees the codec half switched.
+//
 void rt5682s_update_reclock(IN PRTEK_CONTEXT pDevice) {
-	UINT32 mclk = pDevice->mclk;
-	UINT32 freq = pDevice->freq;
-	UINT32 slotWidth = pDevice->slotWidth;
+	struct rt5682s_clock_state* cur = &pDevice->ClockApplied;
+	struct rt5682s_clock_state next;
+	struct rt5682s_batch batch;
 
 	if (!pDevice->ReclockRequested)
 		return;
 
-	UINT32 outclk = freq * 512;
-	if (mclk != outclk)
-		rt5682s_set_component_pll(pDevice, RT5682S_PLL2, RT5682S_PLL_S_MCLK, mclk, outclk);
-	rt5682s_set_tdm_slot(pDevice, 1, 1, 2, slotWidth);
-	rt5682s_set_component_sysclk(pDevice, mclk == outclk ? RT5682S_SCLK_S_MCLK : RT5682S_SCLK_S_PLL2);
-	rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_3,
-		RT5682S_PWR_LDO_PLLB | RT5682S_PWR_BIAS_PLLB | RT5682S_RSTB_PLLB | RT5682S_PWR_PLLB,
-		mclk != outclk ? (RT5682S_PWR_LDO_PLLB | RT5682S_PWR_BIAS_PLLB | RT5682S_RSTB_PLLB | RT5682S_PWR_PLLB) : 0);
+	next.valid = TRUE;
+	next.mclk = pDevice->mclk;
+	next.outclk = pDevice->freq * 512;
+	next.slotWidth = pDevice->slotWidth;
+	next.tdmSlots = pDevice->tdmSlots;
+	next.txMask = pDevice->txMask;
+	next.rxMask = pDevice->rxMask;
+
+	//A layout the codec cannot carry is refused before anything is written
+	struct rt5682s_tdm_layout tdm;
+	if (!NT_SUCCESS(rt5682s_tdm_layout(next.txMask, next.rxMask, next.tdmSlots, next.slotWidth, &tdm))) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Refusing %d x %d bit slots, tx 0x%x rx 0x%x\n",
+			next.tdmSlots, next.slotWidth, next.txMask, next.rxMask);
+		return;
+	}
+
+	LARGE_INTEGER freq;
+	LONGLONG start = KeQueryPerformanceCounter(&freq).QuadPart;
+
+	struct rt5682s_clock_plan plan;
+	if (!rt5682s_clock_plan(pDevice, next.mclk, next.outclk, &plan))
+		return;
+	next.src = plan.src;
+
+	//The applied state is only read and changed inside the batch
+	rt5682s_batch_begin(pDevice, &batch);
+
+	BOOLEAN full = !cur->valid;
+	BOOLEAN onPll = !full && cur->src != RT5682S_CLK_SRC_MCLK;
+	BOOLEAN newSlots = full || cur->slotWidth != next.slotWidth || cur->tdmSlots != next.tdmSlots ||
+		cur->txMask != next.txMask || cur->rxMask != next.rxMask;
+
+	if (!full && !newSlots && cur->mclk == next.mclk && cur->outclk == next.outclk) {
+		rt5682s_batch_commit(&batch);
+		RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "Clocks already at mclk %d, %d Hz, %d x %d bit slots\n",
+			next.mclk, pDevice->freq, next.tdmSlots, next.slotWidth);
+		return;
+	}
+
+	BOOLEAN newDividers = plan.pll && (full || cur->mclk != next.mclk || cur->outclk != next.outclk);
+
+	if (newDividers) {
+		if (full || onPll)
+			rt5682s_batch_sysclk(&batch, RT5682S_CLK_SRC_MCLK);
+
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
+			RT5682S_PLL_POWER_MASK, plan.power);
+		rt5682s_batch_update(&batch, RT5682S_GLB_CLK,
+			RT5682S_PLL_SRC_MASK, RT5682S_PLL_SRC_MCLK);
+		rt5682s_batch_pll(&batch, plan.pll);
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
+			plan.rstb, plan.rstb);
+		rt5682s_batch_settle_begin(&batch, plan.settleMs);
+	}
+
+	if (newSlots)
+		rt5682s_batch_tdm_slot(&batch, &tdm);
+
+	if (newDividers)
+		rt5682s_batch_settle_end(&batch, TRUE);
+
+	if (full || newDividers || cur->src != next.src) {
+		rt5682s_batch_sysclk(&batch, next.src);
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
+			RT5682S_PLL_POWER_MASK, plan.power | plan.rstb);
+	}
+
+	rt5682s_batch_flush(&batch);
+	if (NT_SUCCESS(batch.status))
+		*cur = next;
+	else
+		cur->valid = FALSE;
+	rt5682s_batch_commit(&batch);
+
+	RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "Reclock to mclk %d, %d Hz took %lld us\n",
+		next.mclk, pDevice->freq,
+		(KeQueryPerformanceCounter(NULL).QuadPart - start) * 1000000 / freq.QuadPart);
 }
 
 void StartStopSpeaker(
@@ -506,119 +1933,541 @@ CsAudioCallbackFunction(
 	if (localArg.endpointType == CSAudioEndpointTypeDSP && localArg.endpointRequest == CSAudioEndpointRegister) {
 		CSAudioRegisterEndpoint(pDevice);
 	}
-	else if (localArg.endpointType != CSAudioEndpointTypeHeadphone &&
-		localArg.endpointType != CSAudioEndpointTypeMicJack) { //check both in case user decides to record first
-		return;
+	else if (localArg.endpointType != CSAudioEndpointTypeHeadphone &&
+		localArg.endpointType != CSAudioEndpointTypeMicJack) { //check both in case user decides to record first
+		return;
+	}
+
+	if ((localArg.endpointRequest == CSAudioEndpointStart || localArg.endpointRequest == CSAudioEndpointStop) &&
+		localArg.endpointType == CSAudioEndpointTypeHeadphone) {
+		pDevice->HeadphonePlaying = (localArg.endpointRequest == CSAudioEndpointStart);
+		if (pDevice->JackType == 0 && GetPlatform() == PlatformRyzenCezanne) {
+			StartStopSpeaker(pDevice, localArg.endpointRequest == CSAudioEndpointStart);
+		}
+	}
+
+	if (localArg.endpointRequest == CSAudioEndpointI2SParameters &&
+		localArg.i2sParameters.version >= 1) { //Supports version 1 or higher
+
+		Platform currentPlatform = GetPlatform();
+		if (currentPlatform == PlatformTigerLake) { //Reclock requested
+			UINT32 mclk = localArg.i2sParameters.mclk;
+			UINT32 freq = localArg.i2sParameters.frequency;
+			UINT32 slotWidth = localArg.i2sParameters.valid_bits;
+
+			pDevice->mclk = mclk;
+			pDevice->freq = freq;
+			pDevice->slotWidth = slotWidth;
+
+			//Plain I2S keeps one stereo pair, TDM takes the DSP's layout
+			if (localArg.i2sParameters.tdm_slots > 2) {
+				pDevice->tdmSlots = localArg.i2sParameters.tdm_slots;
+				if (localArg.i2sParameters.tdm_slot_width)
+					pDevice->slotWidth = localArg.i2sParameters.tdm_slot_width;
+				//The codec transmits on the slots the DSP receives on
+				pDevice->txMask = localArg.i2sParameters.rx_slots;
+				pDevice->rxMask = localArg.i2sParameters.tx_slots;
+			}
+			else {
+				pDevice->tdmSlots = 2;
+				pDevice->txMask = 1;
+				pDevice->rxMask = 1;
+			}
+			pDevice->ReclockRequested = TRUE;
+
+			if (KeGetCurrentIrql() > APC_LEVEL)
+				RtekQueueReclockWorkItem(pDevice->FxDevice);
+			else if (rt5682s_wait_ready(pDevice))
+				rt5682s_update_reclock(pDevice);
+		}
+	}
+}
+
+//
+// PLL dividers are solved instead of looked up. Both PLLs run
+// Fin * (N + 2) / ((M + 2) * (K + 2)), where a bypassed M or K divides by 1,
+// and PLLB scales its output by 16/5, or by 21/5 with sel_ps. The phase
+// detector and VCO limits are the ones the vendor divider tables stay
+// within. The solver prefers the smallest error, then the smallest M, then
+// the fastest VCO, which reproduces every entry of those tables.
+//
+// PLL2 runs PLLB from the input, or cascades PLLA into PLLB through a
+// 3.84 MHz reference when that is more accurate. The vendor tables only run
+// PLLB straight from MCLK up to 24.576 MHz, so faster outputs take the
+// cascade whenever it is as accurate.
+//
+// Only exact dividers are accepted unless Settings\PllMaxErrorPpb allows
+// an error, which is capped at RT5682S_PLL_MAX_ERR_PPB.
+//
+struct rt5682s_pll_limits {
+	UINT32 pfdMax;
+	UINT32 vcoMin;
+	UINT32 vcoMax;
+	int nMax;
+	int psCount;
+	UINT8 psNum[2];
+	UINT8 psDen;
+};
+
+static const struct rt5682s_pll_limits rt5682s_plla_limits = { 4096000, 90000000, 98304000, 0x1ff, 1, { 1 }, 1 };
+static const struct rt5682s_pll_limits rt5682s_pllb_limits = { 4800000, 26880000, 38400000, 0x3ff, 2, { 16, 21 }, 5 };
+
+#define RT5682S_PLL_DIV_MAX	(0x1f + 2)
+#define RT5682S_PLLAB_REF	3840000
+#define RT5682S_PLLB_DIRECT_MAX	24576000
+#define RT5682S_PLL_NO_FIT	MAXULONG64
+
+//Returns the output error in parts per billion, RT5682S_PLL_NO_FIT if no divider fits
+static UINT64 rt5682s_pll_solve_one(const struct rt5682s_pll_limits* lim,
+	unsigned int f_in, unsigned int f_out, struct pll_calc_map* map)
+{
+	UINT64 bestErr = RT5682S_PLL_NO_FIT, bestVco = 0;
+	int bestMd = 0;
+
+	for (int md = 1; md <= RT5682S_PLL_DIV_MAX; md++) {
+		if (f_in > (UINT64)lim->pfdMax * md)
+			continue;
+
+		for (int kd = 1; kd <= RT5682S_PLL_DIV_MAX; kd++) {
+			for (int ps = 0; ps < lim->psCount; ps++) {
+				UINT64 num = (UINT64)f_out * kd * md * lim->psDen;
+				UINT64 den = (UINT64)f_in * lim->psNum[ps];
+				UINT64 nd = (num + den / 2) / den;
+				if (nd < 2 || nd - 2 > (UINT64)lim->nMax)
+					continue;
+
+				//VCO times md, compared without rounding
+				UINT64 vco = (UINT64)f_in * nd;
+				if (vco < (UINT64)lim->vcoMin * md || vco > (UINT64)lim->vcoMax * md)
+					continue;
+
+				UINT64 diff = den * nd > num ? den * nd - num : num - den * nd;
+				UINT64 err = diff * 1000000000 / num;
+				if (err > bestErr || (err == bestErr && (md != bestMd || vco <= bestVco)))
+					continue;
+
+				bestErr = err;
+				bestMd = md;
+				bestVco = vco;
+
+				map->freq_in = f_in;
+				map->freq_out = f_out;
+				map->m_bp = md == 1;
+				map->m = map->m_bp ? 0 : md - 2;
+				map->k_bp = kd == 1;
+				map->k = map->k_bp ? 0 : kd - 2;
+				map->n = (int)nd - 2;
+				map->byp_ps = false;
+				map->sel_ps = ps == 1;
+			}
+		}
+	}
+	return bestErr;
+}
+
+static int rt5682s_pll_solve(int pll_id, unsigned int f_in, unsigned int f_out, UINT32 maxErrPpb,
+	struct pll_calc_map* a, struct pll_calc_map* b, UINT32* ppb)
+{
+	UINT64 err;
+	int comb;
+
+	if (pll_id == RT5682S_PLL1) {
+		err = rt5682s_pll_solve_one(&rt5682s_plla_limits, f_in, f_out, a);
+		comb = USE_PLLA;
+	}
+	else if (pll_id == RT5682S_PLL2) {
+		err = rt5682s_pll_solve_one(&rt5682s_pllb_limits, f_in, f_out, b);
+		comb = USE_PLLB;
+
+		BOOLEAN cascade = f_out > RT5682S_PLLB_DIRECT_MAX && f_in != RT5682S_PLLAB_REF;
+		if (err || cascade) {
+			struct pll_calc_map ca, cb;
+			UINT64 errA = rt5682s_pll_solve_one(&rt5682s_plla_limits, f_in, RT5682S_PLLAB_REF, &ca);
+			UINT64 errB = rt5682s_pll_solve_one(&rt5682s_pllb_limits, RT5682S_PLLAB_REF, f_out, &cb);
+			if (errA != RT5682S_PLL_NO_FIT && errB != RT5682S_PLL_NO_FIT &&
+				(errA + errB < err || (cascade && errA + errB <= err))) {
+				*a = ca;
+				*b = cb;
+				err = errA + errB;
+				comb = USE_PLLAB;
+			}
+		}
+	}
+	else {
+		return -1;
+	}
+
+	if (err > maxErrPpb)
+		return -1;
+
+	if (err) {
+		RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "PLL%d:(%d->%d) is off by %llu ppb\n",
+			pll_id + 1, f_in, f_out, err);
+	}
+	*ppb = (UINT32)err;
+	return comb;
+}
+
+//Collects the PLL_CTRL_1..7 fields of a solved conversion for one block write
+static void rt5682s_pll_encode(struct rt5682s_pll_config* cfg,
+	const struct pll_calc_map* a, const struct pll_calc_map* b)
+{
+	RtlZeroMemory(cfg->masks, sizeof(cfg->masks));
+	RtlZeroMemory(cfg->vals, sizeof(cfg->vals));
+#define PLL_SET(reg, mask, val) do { \
+		cfg->masks[(reg) - RT5682S_PLL_CTRL_1] |= (mask); \
+		cfg->vals[(reg) - RT5682S_PLL_CTRL_1] |= (val) & (mask); \
+	} while (0)
+
+	if (cfg->comb == USE_PLLA || cfg->comb == USE_PLLAB) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "PLLA: fin=%d fout=%d m_bp=%d k_bp=%d m=%d n=%d k=%d\n",
+			a->freq_in, a->freq_out, a->m_bp, a->k_bp,
+			(a->m_bp ? 0 : a->m), a->n, (a->k_bp ? 0 : a->k));
+		PLL_SET(RT5682S_PLL_CTRL_1,
+			RT5682S_PLLA_N_MASK, a->n);
+		PLL_SET(RT5682S_PLL_CTRL_2,
+			RT5682S_PLLA_M_MASK | RT5682S_PLLA_K_MASK,
+			a->m << RT5682S_PLLA_M_SFT | a->k);
+		PLL_SET(RT5682S_PLL_CTRL_6,
+			RT5682S_PLLA_M_BP_MASK | RT5682S_PLLA_K_BP_MASK,
+			a->m_bp << RT5682S_PLLA_M_BP_SFT |
+			a->k_bp << RT5682S_PLLA_K_BP_SFT);
 	}
 
-	if ((localArg.endpointRequest == CSAudioEndpointStart || localArg.endpointRequest == CSAudioEndpointStop) &&
-		localArg.endpointType == CSAudioEndpointTypeHeadphone) {
-		pDevice->HeadphonePlaying = (localArg.endpointRequest == CSAudioEndpointStart);
-		if (pDevice->JackType == 0 && GetPlatform() == PlatformRyzenCezanne) {
-			StartStopSpeaker(pDevice, localArg.endpointRequest == CSAudioEndpointStart);
-		}
+	if (cfg->comb == USE_PLLB || cfg->comb == USE_PLLAB) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "PLLB: fin=%d fout=%d m_bp=%d k_bp=%d m=%d n=%d k=%d byp_ps=%d sel_ps=%d\n",
+			b->freq_in, b->freq_out, b->m_bp, b->k_bp,
+			(b->m_bp ? 0 : b->m), b->n, (b->k_bp ? 0 : b->k),
+			b->byp_ps, b->sel_ps);
+		PLL_SET(RT5682S_PLL_CTRL_3,
+			RT5682S_PLLB_N_MASK, b->n);
+		PLL_SET(RT5682S_PLL_CTRL_4,
+			RT5682S_PLLB_M_MASK | RT5682S_PLLB_K_MASK,
+			b->m << RT5682S_PLLB_M_SFT | b->k);
+		PLL_SET(RT5682S_PLL_CTRL_6,
+			RT5682S_PLLB_SEL_PS_MASK | RT5682S_PLLB_BYP_PS_MASK |
+			RT5682S_PLLB_M_BP_MASK | RT5682S_PLLB_K_BP_MASK,
+			b->sel_ps << RT5682S_PLLB_SEL_PS_SFT |
+			b->byp_ps << RT5682S_PLLB_BYP_PS_SFT |
+			b->m_bp << RT5682S_PLLB_M_BP_SFT |
+			b->k_bp << RT5682S_PLLB_K_BP_SFT);
 	}
 
-	if (localArg.endpointRequest == CSAudioEndpointI2SParameters &&
-		localArg.i2sParameters.version >= 1) { //Supports version 1 or higher
+	if (cfg->comb == USE_PLLB)
+		PLL_SET(RT5682S_PLL_CTRL_7,
+			RT5682S_PLLB_SRC_MASK, RT5682S_PLLB_SRC_DFIN);
+	else if (cfg->comb == USE_PLLAB)
+		PLL_SET(RT5682S_PLL_CTRL_7,
+			RT5682S_PLLB_SRC_MASK, RT5682S_PLLB_SRC_PLLA);
 
-		Platform currentPlatform = GetPlatform();
-		if (currentPlatform == PlatformTigerLake) { //Reclock requested
-			UINT32 mclk = localArg.i2sParameters.mclk;
-			UINT32 freq = localArg.i2sParameters.frequency;
-			UINT32 slotWidth = localArg.i2sParameters.valid_bits;
+#undef PLL_SET
+}
 
-			pDevice->mclk = mclk;
-			pDevice->freq = freq;
-			pDevice->slotWidth = slotWidth;
-			pDevice->ReclockRequested = TRUE;
+//
+// Every exact conversion from a supported MCLK to a 512 fs sysclk for 44.1,
+// 48, 96 and 192 kHz, cascades included, and every vendor table entry are
+// encoded at compile time, exactly as the solver would produce them, sorted
+// by pll_id, freq_in and freq_out. Anything else is solved once, outside
+// RegCacheLock, and kept in a direct mapped per-device cache, failures
+// included.
+//
+#define RT5682S_PLLA_CTRL_6(m_bp, k_bp) \
+	((m_bp) << RT5682S_PLLA_M_BP_SFT | (k_bp) << RT5682S_PLLA_K_BP_SFT)
+#define RT5682S_PLLB_CTRL_6(m_bp, k_bp, sel_ps) \
+	((sel_ps) << RT5682S_PLLB_SEL_PS_SFT | (m_bp) << RT5682S_PLLB_M_BP_SFT | (k_bp) << RT5682S_PLLB_K_BP_SFT)
+
+#define RT5682S_PLLA_CONFIG(fin, fout, m, n, k, m_bp, k_bp) { RT5682S_PLL1, fin, fout, USE_PLLA, \
+	{ RT5682S_PLLA_N_MASK, RT5682S_PLLA_M_MASK | RT5682S_PLLA_K_MASK, 0, 0, 0, \
+		RT5682S_PLLA_M_BP_MASK | RT5682S_PLLA_K_BP_MASK, 0 }, \
+	{ n, (m) << RT5682S_PLLA_M_SFT | (k), 0, 0, 0, RT5682S_PLLA_CTRL_6(m_bp, k_bp), 0 } }
+
+#define RT5682S_PLLB_CONFIG(fin, fout, m, n, k, m_bp, k_bp, sel_ps) { RT5682S_PLL2, fin, fout, USE_PLLB, \
+	{ 0, 0, RT5682S_PLLB_N_MASK, RT5682S_PLLB_M_MASK | RT5682S_PLLB_K_MASK, 0, \
+		RT5682S_PLLB_SEL_PS_MASK | RT5682S_PLLB_BYP_PS_MASK | RT5682S_PLLB_M_BP_MASK | RT5682S_PLLB_K_BP_MASK, \
+		RT5682S_PLLB_SRC_MASK }, \
+	{ 0, 0, n, (m) << RT5682S_PLLB_M_SFT | (k), 0, RT5682S_PLLB_CTRL_6(m_bp, k_bp, sel_ps), RT5682S_PLLB_SRC_DFIN } }
+
+#define RT5682S_PLLAB_CONFIG(fin, fout, am, an, ak, am_bp, ak_bp, bm, bn, bk, bm_bp, bk_bp, sel_ps) { \
+	RT5682S_PLL2, fin, fout, USE_PLLAB, \
+	{ RT5682S_PLLA_N_MASK, RT5682S_PLLA_M_MASK | RT5682S_PLLA_K_MASK, \
+		RT5682S_PLLB_N_MASK, RT5682S_PLLB_M_MASK | RT5682S_PLLB_K_MASK, 0, \
+		RT5682S_PLLA_M_BP_MASK | RT5682S_PLLA_K_BP_MASK | \
+		RT5682S_PLLB_SEL_PS_MASK | RT5682S_PLLB_BYP_PS_MASK | RT5682S_PLLB_M_BP_MASK | RT5682S_PLLB_K_BP_MASK, \
+		RT5682S_PLLB_SRC_MASK }, \
+	{ an, (am) << RT5682S_PLLA_M_SFT | (ak), bn, (bm) << RT5682S_PLLB_M_SFT | (bk), 0, \
+		RT5682S_PLLA_CTRL_6(am_bp, ak_bp) | RT5682S_PLLB_CTRL_6(bm_bp, bk_bp, sel_ps), RT5682S_PLLB_SRC_PLLA } }
+
+static const struct rt5682s_pll_config rt5682s_pll_presets[] = {
+	RT5682S_PLLA_CONFIG(256000, 24576000, 0, 382, 2, true, false),
+	RT5682S_PLLA_CONFIG(256000, 49152000, 0, 382, 0, true, false),
+	RT5682S_PLLA_CONFIG(256000, 98304000, 0, 382, 0, true, true),
+	RT5682S_PLLA_CONFIG(512000, 24576000, 0, 190, 2, true, false),
+	RT5682S_PLLA_CONFIG(512000, 49152000, 0, 190, 0, true, false),
+	RT5682S_PLLA_CONFIG(512000, 98304000, 0, 190, 0, true, true),
+	RT5682S_PLLA_CONFIG(1024000, 22579200, 3, 439, 2, false, false),
+	RT5682S_PLLA_CONFIG(1024000, 24576000, 0, 94, 2, true, false),
+	RT5682S_PLLA_CONFIG(1024000, 49152000, 0, 94, 0, true, false),
+	RT5682S_PLLA_CONFIG(1024000, 98304000, 0, 94, 0, true, true),
+	RT5682S_PLLA_CONFIG(1411200, 22579200, 0, 62, 2, true, false),
+	RT5682S_PLLA_CONFIG(1536000, 22579200, 3, 292, 2, false, false),
+	RT5682S_PLLA_CONFIG(1536000, 24576000, 0, 62, 2, true, false),
+	RT5682S_PLLA_CONFIG(1536000, 49152000, 0, 62, 0, true, false),
+	RT5682S_PLLA_CONFIG(1536000, 98304000, 0, 62, 0, true, true),
+	RT5682S_PLLA_CONFIG(2048000, 22579200, 8, 439, 2, false, false),
+	RT5682S_PLLA_CONFIG(2048000, 24576000, 0, 46, 2, true, false),
+	RT5682S_PLLA_CONFIG(2048000, 49152000, 0, 46, 0, true, false),
+	RT5682S_PLLA_CONFIG(2048000, 98304000, 0, 46, 0, true, true),
+	RT5682S_PLLA_CONFIG(2822400, 22579200, 0, 30, 2, true, false),
+	RT5682S_PLLA_CONFIG(3072000, 22579200, 3, 145, 2, false, false),
+	RT5682S_PLLA_CONFIG(3072000, 24576000, 0, 30, 2, true, false),
+	RT5682S_PLLA_CONFIG(3072000, 49152000, 0, 30, 0, true, false),
+	RT5682S_PLLA_CONFIG(3072000, 98304000, 0, 30, 0, true, true),
+	RT5682S_PLLA_CONFIG(4096000, 22579200, 18, 439, 2, false, false),
+	RT5682S_PLLA_CONFIG(4096000, 24576000, 0, 22, 2, true, false),
+	RT5682S_PLLA_CONFIG(4096000, 49152000, 0, 22, 0, true, false),
+	RT5682S_PLLA_CONFIG(4096000, 98304000, 0, 22, 0, true, true),
+	RT5682S_PLLA_CONFIG(6144000, 22579200, 8, 145, 2, false, false),
+	RT5682S_PLLA_CONFIG(6144000, 24576000, 0, 30, 2, false, false),
+	RT5682S_PLLA_CONFIG(6144000, 49152000, 0, 30, 0, false, false),
+	RT5682S_PLLA_CONFIG(6144000, 98304000, 0, 30, 0, false, true),
+	RT5682S_PLLA_CONFIG(11289600, 22579200, 1, 22, 2, false, false),
+	RT5682S_PLLA_CONFIG(12288000, 22579200, 18, 145, 2, false, false),
+	RT5682S_PLLA_CONFIG(12288000, 24576000, 1, 22, 2, false, false),
+	RT5682S_PLLA_CONFIG(12288000, 49152000, 1, 22, 0, false, false),
+	RT5682S_PLLA_CONFIG(12288000, 98304000, 1, 22, 0, false, true),
+	RT5682S_PLLA_CONFIG(19200000, 3840000, 3, 23, 23, false, false),
+	RT5682S_PLLA_CONFIG(19200000, 24576000, 23, 126, 2, false, false),
+	RT5682S_PLLA_CONFIG(19200000, 49152000, 23, 126, 0, false, false),
+	RT5682S_PLLA_CONFIG(19200000, 98304000, 23, 126, 0, false, true),
+	RT5682S_PLLA_CONFIG(24000000, 3840000, 4, 22, 23, false, false),
+	RT5682S_PLLA_CONFIG(24576000, 49152000, 4, 22, 0, false, false),
+	RT5682S_PLLA_CONFIG(24576000, 98304000, 4, 22, 0, false, true),
+	RT5682S_PLLA_CONFIG(38400000, 3840000, 8, 23, 23, false, false),
+	RT5682S_PLLA_CONFIG(38400000, 24576000, 23, 62, 2, false, false),
+	RT5682S_PLLA_CONFIG(38400000, 49152000, 23, 62, 0, false, false),
+	RT5682S_PLLA_CONFIG(38400000, 98304000, 23, 62, 0, false, true),
+	RT5682S_PLLA_CONFIG(48000000, 3840000, 10, 22, 23, false, false),
+	RT5682S_PLLA_CONFIG(49152000, 24576000, 10, 22, 2, false, false),
+	RT5682S_PLLA_CONFIG(49152000, 98304000, 10, 22, 0, false, true),
+	RT5682S_PLLB_CONFIG(256000, 22579200, 0, 145, 5, true, false, true),
+	RT5682S_PLLB_CONFIG(256000, 24576000, 0, 148, 3, true, false, false),
+	RT5682S_PLLAB_CONFIG(256000, 49152000, 0, 373, 23, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(256000, 98304000, 0, 373, 23, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(512000, 22579200, 0, 61, 4, true, false, true),
+	RT5682S_PLLB_CONFIG(512000, 24576000, 0, 73, 3, true, false, false),
+	RT5682S_PLLAB_CONFIG(512000, 49152000, 0, 178, 22, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(512000, 98304000, 0, 178, 22, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(1024000, 22579200, 0, 61, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(1024000, 24576000, 0, 28, 2, true, false, false),
+	RT5682S_PLLAB_CONFIG(1024000, 49152000, 0, 88, 22, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(1024000, 98304000, 0, 88, 22, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(1411200, 22579200, 0, 23, 3, true, false, false),
+	RT5682S_PLLB_CONFIG(1536000, 22579200, 0, 19, 4, true, false, true),
+	RT5682S_PLLB_CONFIG(1536000, 24576000, 0, 23, 3, true, false, false),
+	RT5682S_PLLAB_CONFIG(1536000, 49152000, 0, 58, 22, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(1536000, 98304000, 0, 58, 22, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(2048000, 22579200, 2, 61, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(2048000, 24576000, 0, 13, 2, true, false, false),
+	RT5682S_PLLAB_CONFIG(2048000, 49152000, 0, 43, 22, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(2048000, 98304000, 0, 43, 22, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(2822400, 22579200, 0, 8, 2, true, false, false),
+	RT5682S_PLLB_CONFIG(3072000, 22579200, 0, 19, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(3072000, 24576000, 0, 8, 2, true, false, false),
+	RT5682S_PLLAB_CONFIG(3072000, 49152000, 0, 28, 22, true, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(3072000, 98304000, 0, 28, 22, true, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(3840000, 49152000, 0, 6, 0, true, false, false),
+	RT5682S_PLLB_CONFIG(4096000, 22579200, 6, 61, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(4096000, 24576000, 0, 13, 2, false, false, false),
+	RT5682S_PLLAB_CONFIG(4096000, 49152000, 0, 43, 22, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(4096000, 98304000, 0, 43, 22, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(6144000, 22579200, 2, 19, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(6144000, 24576000, 0, 8, 2, false, false, false),
+	RT5682S_PLLAB_CONFIG(6144000, 49152000, 0, 28, 22, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(6144000, 98304000, 0, 28, 22, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(11289600, 22579200, 1, 8, 5, false, false, true),
+	RT5682S_PLLB_CONFIG(12288000, 22579200, 6, 19, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(12288000, 24576000, 2, 8, 2, false, false, false),
+	RT5682S_PLLAB_CONFIG(12288000, 49152000, 2, 28, 22, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(12288000, 98304000, 2, 28, 22, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(19200000, 22579200, 3, 5, 3, false, false, true),
+	RT5682S_PLLB_CONFIG(19200000, 24576000, 2, 6, 3, false, false, false),
+	RT5682S_PLLAB_CONFIG(19200000, 49152000, 3, 23, 23, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(19200000, 98304000, 3, 23, 23, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(24000000, 22579200, 23, 26, 3, false, false, true),
+	RT5682S_PLLB_CONFIG(24000000, 24576000, 3, 6, 3, false, false, false),
+	RT5682S_PLLAB_CONFIG(24000000, 49152000, 4, 22, 23, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(24000000, 98304000, 4, 22, 23, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(24576000, 22579200, 14, 19, 4, false, false, true),
+	RT5682S_PLLAB_CONFIG(24576000, 49152000, 6, 28, 22, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(24576000, 98304000, 6, 28, 22, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(38400000, 22579200, 8, 5, 3, false, false, true),
+	RT5682S_PLLB_CONFIG(38400000, 24576000, 6, 6, 3, false, false, false),
+	RT5682S_PLLAB_CONFIG(38400000, 49152000, 8, 23, 23, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(38400000, 98304000, 8, 23, 23, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(48000000, 22579200, 23, 12, 3, false, false, true),
+	RT5682S_PLLB_CONFIG(48000000, 24576000, 8, 6, 3, false, false, false),
+	RT5682S_PLLAB_CONFIG(48000000, 49152000, 10, 22, 23, false, false, 0, 6, 0, true, false, false),
+	RT5682S_PLLAB_CONFIG(48000000, 98304000, 10, 22, 23, false, false, 0, 6, 0, true, true, false),
+	RT5682S_PLLB_CONFIG(49152000, 22579200, 30, 19, 4, false, false, true),
+	RT5682S_PLLB_CONFIG(49152000, 24576000, 12, 8, 4, false, false, true),
+	RT5682S_PLLAB_CONFIG(49152000, 98304000, 14, 28, 22, false, false, 0, 6, 0, true, true, false),
+};
 
-			rt5682s_update_reclock(pDevice);
-		}
+static int rt5682s_pll_key_cmp(const struct rt5682s_pll_config* cfg,
+	int pll_id, unsigned int f_in, unsigned int f_out)
+{
+	if (cfg->pll_id != pll_id)
+		return cfg->pll_id < pll_id ? -1 : 1;
+	if (cfg->freq_in != f_in)
+		return cfg->freq_in < f_in ? -1 : 1;
+	if (cfg->freq_out != f_out)
+		return cfg->freq_out < f_out ? -1 : 1;
+	return 0;
+}
+
+//
+// Presets are returned as is. Other conversions are copied to the caller's
+// scratch config, so RegCacheLock is only taken to read or fill the cache
+// slot and never while solving. Caller must not hold RegCacheLock.
+//
+static const struct rt5682s_pll_config* rt5682s_pll_find(PRTEK_CONTEXT pDevice,
+	int pll_id, unsigned int f_in, unsigned int f_out, struct rt5682s_pll_config* scratch)
+{
+	int lo = 0, hi = sizeof(rt5682s_pll_presets) / sizeof(rt5682s_pll_presets[0]) - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int cmp = rt5682s_pll_key_cmp(&rt5682s_pll_presets[mid], pll_id, f_in, f_out);
+		if (!cmp)
+			return &rt5682s_pll_presets[mid];
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
 	}
+
+	struct rt5682s_pll_config* cfg = &pDevice->PllCache[
+		((f_in / 1000) ^ (f_out / 1000) * 7 ^ pll_id) & (RT5682S_PLL_CACHE_SIZE - 1)];
+
+	rt5682s_reg_lock(pDevice);
+	BOOLEAN hit = cfg->freq_in && !rt5682s_pll_key_cmp(cfg, pll_id, f_in, f_out);
+	if (hit)
+		*scratch = *cfg;
+	rt5682s_reg_unlock(pDevice);
+	if (hit)
+		return scratch;
+
+	struct pll_calc_map a, b;
+	RtlZeroMemory(&a, sizeof(a));
+	RtlZeroMemory(&b, sizeof(b));
+
+	scratch->pll_id = pll_id;
+	scratch->freq_in = f_in;
+	scratch->freq_out = f_out;
+	scratch->errPpb = 0;
+	scratch->comb = rt5682s_pll_solve(pll_id, f_in, f_out, pDevice->PllMaxErrPpb, &a, &b, &scratch->errPpb);
+	rt5682s_pll_encode(scratch, &a, &b);
+
+	rt5682s_reg_lock(pDevice);
+	*cfg = *scratch;
+	rt5682s_reg_unlock(pDevice);
+	return scratch;
 }
 
-static const struct pll_calc_map plla_table[] = {
-	{2048000, 24576000, 0, 46, 2, true, false, false, false},
-	{256000, 24576000, 0, 382, 2, true, false, false, false},
-	{512000, 24576000, 0, 190, 2, true, false, false, false},
-	{4096000, 24576000, 0, 22, 2, true, false, false, false},
-	{1024000, 24576000, 0, 94, 2, true, false, false, false},
-	{11289600, 22579200, 1, 22, 2, false, false, false, false},
-	{1411200, 22579200, 0, 62, 2, true, false, false, false},
-	{2822400, 22579200, 0, 30, 2, true, false, false, false},
-	{12288000, 24576000, 1, 22, 2, false, false, false, false},
-	{1536000, 24576000, 0, 62, 2, true, false, false, false},
-	{3072000, 24576000, 0, 30, 2, true, false, false, false},
-	{24576000, 49152000, 4, 22, 0, false, false, false, false},
-	{3072000, 49152000, 0, 30, 0, true, false, false, false},
-	{6144000, 49152000, 0, 30, 0, false, false, false, false},
-	{49152000, 98304000, 10, 22, 0, false, true, false, false},
-	{6144000, 98304000, 0, 30, 0, false, true, false, false},
-	{12288000, 98304000, 1, 22, 0, false, true, false, false},
-	{48000000, 3840000, 10, 22, 23, false, false, false, false},
-	{24000000, 3840000, 4, 22, 23, false, false, false, false},
-	{19200000, 3840000, 3, 23, 23, false, false, false, false},
-	{38400000, 3840000, 8, 23, 23, false, false, false, false},
-};
+//Queues the divider fields of a conversion as masked updates, so they join the surrounding sequence
+static void rt5682s_batch_pll(struct rt5682s_batch* batch, const struct rt5682s_pll_config* cfg)
+{
+	for (int i = 0; i < RT5682S_PLL_CTRL_COUNT; i++) {
+		if (cfg->masks[i])
+			rt5682s_batch_update(batch, RT5682S_PLL_CTRL_1 + i, cfg->masks[i], cfg->vals[i]);
+	}
+}
 
-static const struct pll_calc_map pllb_table[] = {
-	{48000000, 24576000, 8, 6, 3, false, false, false, false},
-	{48000000, 22579200, 23, 12, 3, false, false, false, true},
-	{24000000, 24576000, 3, 6, 3, false, false, false, false},
-	{24000000, 22579200, 23, 26, 3, false, false, false, true},
-	{19200000, 24576000, 2, 6, 3, false, false, false, false},
-	{19200000, 22579200, 3, 5, 3, false, false, false, true},
-	{38400000, 24576000, 6, 6, 3, false, false, false, false},
-	{38400000, 22579200, 8, 5, 3, false, false, false, true},
-	{3840000, 49152000, 0, 6, 0, true, false, false, false},
+//
+// Relative cost of each PLL combination. Power follows the VCO range, PLLA
+// runs near 94 MHz against 27 to 38 MHz for PLLB, and a cascade pays for
+// both. Lock time is conservative; PLLB in a cascade only starts to lock once
+// PLLA is stable. RCCLK is not locked to MCLK, so it never carries audio.
+//
+static const struct rt5682s_pll_cost {
+	UINT8 power;
+	UINT8 lockMs;
+} rt5682s_pll_costs[] = {
+	{ 3, 1 },	//USE_PLLA
+	{ 2, 1 },	//USE_PLLB
+	{ 5, 2 },	//USE_PLLAB
 };
 
-static int find_pll_inter_combination(unsigned int f_in, unsigned int f_out,
-	struct pll_calc_map* a, struct pll_calc_map* b)
+//
+// Sysclk is 512 fs for both rate families, so a 44.1 kHz family rate on a
+// 48 kHz family MCLK, or the other way round, is rarely met by PLLB alone.
+// MCLK is used as is when it already is the sysclk. Otherwise every PLL path
+// that reaches the sysclk is scored: the most accurate wins, then the one
+// drawing the least power, then the one locking fastest. Caller must not
+// hold RegCacheLock.
+//
+static BOOLEAN rt5682s_clock_plan(PRTEK_CONTEXT pDevice, UINT32 mclk, UINT32 sysclk,
+	struct rt5682s_clock_plan* plan)
 {
-	int i, j;
-
-	/* Look at PLLA table */
-	for (i = 0; i < sizeof(plla_table) / sizeof(plla_table[0]); i++) {
-		if (plla_table[i].freq_in == f_in && plla_table[i].freq_out == f_out) {
-			memcpy(a, plla_table + i, sizeof(*a));
-			return USE_PLLA;
+	RtlZeroMemory(plan, sizeof(*plan));
+	plan->src = RT5682S_CLK_SRC_MCLK;
+	if (mclk == sysclk)
+		return TRUE;
+
+	const struct rt5682s_pll_config* paths[] = {
+		rt5682s_pll_find(pDevice, RT5682S_PLL2, mclk, sysclk, &plan->solved[0]),
+		rt5682s_pll_find(pDevice, RT5682S_PLL1, mclk, sysclk, &plan->solved[1]),
+	};
+	const struct rt5682s_pll_cost* best = NULL;
+
+	for (int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+		const struct rt5682s_pll_config* cfg = paths[i];
+		if (cfg->comb < 0)
+			continue;
+
+		const struct rt5682s_pll_cost* cost = &rt5682s_pll_costs[cfg->comb];
+		if (best) {
+			if (cfg->errPpb != plan->pll->errPpb) {
+				if (cfg->errPpb > plan->pll->errPpb)
+					continue;
+			}
+			else if (cost->power != best->power) {
+				if (cost->power > best->power)
+					continue;
+			}
+			else if (cost->lockMs >= best->lockMs) {
+				continue;
+			}
 		}
+
+		plan->pll = cfg;
+		best = cost;
 	}
 
-	/* Look at PLLB table */
-	for (i = 0; i < sizeof(pllb_table) / sizeof(pllb_table[0]); i++) {
-		if (pllb_table[i].freq_in == f_in && pllb_table[i].freq_out == f_out) {
-			memcpy(b, pllb_table + i, sizeof(*b));
-			return USE_PLLB;
-		}
+	if (!plan->pll) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "No PLL reaches %d Hz from mclk %d\n", sysclk, mclk);
+		return FALSE;
 	}
 
-	/* Find a combination of PLLA & PLLB */
-	for (i = (sizeof(plla_table) / sizeof(plla_table[0])) - 1; i >= 0; i--) {
-		if (plla_table[i].freq_in == f_in && plla_table[i].freq_out == 3840000) {
-			for (j = (sizeof(pllb_table) / sizeof(pllb_table[0])) - 1; j >= 0; j--) {
-				if (pllb_table[j].freq_in == 3840000 &&
-					pllb_table[j].freq_out == f_out) {
-					memcpy(a, plla_table + i, sizeof(*a));
-					memcpy(b, pllb_table + j, sizeof(*b));
-					return USE_PLLAB;
-				}
-			}
-		}
+	plan->src = plan->pll->pll_id == RT5682S_PLL1 ? RT5682S_CLK_SRC_PLL1 : RT5682S_CLK_SRC_PLL2;
+	plan->settleMs = best->lockMs;
+	if (plan->pll->comb != USE_PLLB) {
+		plan->power |= RT5682S_PLLA_POWER;
+		plan->rstb |= RT5682S_RSTB_PLLA;
+	}
+	if (plan->pll->comb != USE_PLLA) {
+		plan->power |= RT5682S_PLLB_POWER;
+		plan->rstb |= RT5682S_RSTB_PLLB;
 	}
 
-	return -1;
+	RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP, "Sysclk %d Hz from PLL%d (comb %d), %u ppb, power %d, lock %d ms\n",
+		sysclk, plan->pll->pll_id + 1, plan->pll->comb, plan->pll->errPpb, best->power, best->lockMs);
+	return TRUE;
 }
 
-
 NTSTATUS rt5682s_set_component_pll(PRTEK_CONTEXT  pDevice,
 	int pll_id, int source, unsigned int freq_in,
 	unsigned int freq_out)
 {
-	struct pll_calc_map a_map, b_map;
-
 	if (!freq_in || !freq_out) {
 		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "PLL disabled\n");
 		rt5682s_reg_update(pDevice, RT5682S_GLB_CLK,
@@ -640,139 +2489,147 @@ NTSTATUS rt5682s_set_component_pll(PRTEK_CONTEXT  pDevice,
 		return STATUS_INVALID_PARAMETER;
 	}
 
-	int pll_comb = find_pll_inter_combination(freq_in, freq_out,
-		&a_map, &b_map);
-
-	if ((pll_id == RT5682S_PLL1 && pll_comb == USE_PLLA) ||
-		(pll_id == RT5682S_PLL2 && (pll_comb == USE_PLLB ||
-			pll_comb == USE_PLLAB))) {
-		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Supported freq conversion for PLL%d:(%d->%d): %d\n",
-			pll_id + 1, freq_in, freq_out, rt5682s->pll_comb);
-	}
-	else {
-		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Unsupported freq conversion for PLL%d:(%d->%d): %d\n",
-			pll_id + 1, freq_in, freq_out, rt5682s->pll_comb);
+	struct rt5682s_pll_config solved;
+	const struct rt5682s_pll_config* cfg = rt5682s_pll_find(pDevice, pll_id, freq_in, freq_out, &solved);
+	if (cfg->comb < 0) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Unsupported freq conversion for PLL%d:(%d->%d)\n",
+			pll_id + 1, freq_in, freq_out);
 		return STATUS_INVALID_PARAMETER;
 	}
 
-	if (pll_comb == USE_PLLA || pll_comb == USE_PLLAB) {
-		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "PLLA: fin=%d fout=%d m_bp=%d k_bp=%d m=%d n=%d k=%d\n",
-			a_map.freq_in, a_map.freq_out, a_map.m_bp, a_map.k_bp,
-			(a_map.m_bp ? 0 : a_map.m), a_map.n, (a_map.k_bp ? 0 : a_map.k));
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_1,
-			RT5682S_PLLA_N_MASK, a_map.n);
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_2,
-			RT5682S_PLLA_M_MASK | RT5682S_PLLA_K_MASK,
-			a_map.m << RT5682S_PLLA_M_SFT | a_map.k);
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_6,
-			RT5682S_PLLA_M_BP_MASK | RT5682S_PLLA_K_BP_MASK,
-			a_map.m_bp << RT5682S_PLLA_M_BP_SFT |
-			a_map.k_bp << RT5682S_PLLA_K_BP_SFT);
-	}
-
-	if (pll_comb == USE_PLLB || pll_comb == USE_PLLAB) {
-		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "PLLB: fin=%d fout=%d m_bp=%d k_bp=%d m=%d n=%d k=%d byp_ps=%d sel_ps=%d\n",
-			b_map.freq_in, b_map.freq_out, b_map.m_bp, b_map.k_bp,
-			(b_map.m_bp ? 0 : b_map.m), b_map.n, (b_map.k_bp ? 0 : b_map.k),
-			b_map.byp_ps, b_map.sel_ps);
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_3,
-			RT5682S_PLLB_N_MASK, b_map.n);
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_4,
-			RT5682S_PLLB_M_MASK | RT5682S_PLLB_K_MASK,
-			b_map.m << RT5682S_PLLB_M_SFT | b_map.k);
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_6,
-			RT5682S_PLLB_SEL_PS_MASK | RT5682S_PLLB_BYP_PS_MASK |
-			RT5682S_PLLB_M_BP_MASK | RT5682S_PLLB_K_BP_MASK,
-			b_map.sel_ps << RT5682S_PLLB_SEL_PS_SFT |
-			b_map.byp_ps << RT5682S_PLLB_BYP_PS_SFT |
-			b_map.m_bp << RT5682S_PLLB_M_BP_SFT |
-			b_map.k_bp << RT5682S_PLLB_K_BP_SFT);
-	}
-
-	if (pll_comb == USE_PLLB)
-		rt5682s_reg_update(pDevice, RT5682S_PLL_CTRL_7,
-			RT5682S_PLLB_SRC_MASK, RT5682S_PLLB_SRC_DFIN);
+	RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Supported freq conversion for PLL%d:(%d->%d): %d\n",
+		pll_id + 1, freq_in, freq_out, cfg->comb);
 
-	return STATUS_SUCCESS;
+	//PLL_CTRL_1..7 are consecutive and go out as one block
+	rt5682s_reg_lock(pDevice);
+	NTSTATUS status = rt5682s_reg_raw_block_update(pDevice, RT5682S_PLL_CTRL_1, RT5682S_PLL_CTRL_COUNT,
+		cfg->masks, cfg->vals);
+	rt5682s_reg_unlock(pDevice);
+	return status;
 }
 
-NTSTATUS rt5682s_set_tdm_slot(PRTEK_CONTEXT  pDevice, unsigned int tx_mask,
-	unsigned int rx_mask, int slots, int slot_width)
+//
+// Slot layouts are validated and turned into register fields before any of
+// them is written. ADC data goes out in up to four consecutive slots starting
+// at the lowest slot in tx_mask, and the DAC takes its data from the first
+// two slots, so rx_mask may only name those.
+//
+static NTSTATUS rt5682s_tdm_layout(unsigned int tx_mask, unsigned int rx_mask,
+	int slots, int slot_width, struct rt5682s_tdm_layout* layout)
 {
-	unsigned int cl, val = 0, tx_slotnum;
+	unsigned int tx_slotnum = hweight_long(tx_mask);
 
-	if (tx_mask || rx_mask)
-		rt5682s_reg_update(pDevice, RT5682S_TDM_ADDA_CTRL_2, RT5682S_TDM_EN, RT5682S_TDM_EN);
-	else
-		rt5682s_reg_update(pDevice, RT5682S_TDM_ADDA_CTRL_2, RT5682S_TDM_EN, 0);
-
-	/* Tx slot configuration */
-	tx_slotnum = hweight_long(tx_mask);
-	if (tx_slotnum) {
-		if (tx_slotnum > slots) {
-			RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Invalid or oversized Tx slots.\n");
-			return STATUS_INVALID_PARAMETER;
-		}
-		val |= (tx_slotnum - 1) << RT5682S_TDM_ADC_DL_SFT;
-	}
+	RtlZeroMemory(layout, sizeof(*layout));
+	layout->enable = (tx_mask || rx_mask) ? RT5682S_TDM_EN : 0;
 
 	switch (slots) {
 	case 4:
-		val |= RT5682S_TDM_TX_CH_4;
-		val |= RT5682S_TDM_RX_CH_4;
+		layout->ctrl |= RT5682S_TDM_TX_CH_4;
+		layout->ctrl |= RT5682S_TDM_RX_CH_4;
 		break;
 	case 6:
-		val |= RT5682S_TDM_TX_CH_6;
-		val |= RT5682S_TDM_RX_CH_6;
+		layout->ctrl |= RT5682S_TDM_TX_CH_6;
+		layout->ctrl |= RT5682S_TDM_RX_CH_6;
 		break;
 	case 8:
-		val |= RT5682S_TDM_TX_CH_8;
-		val |= RT5682S_TDM_RX_CH_8;
+		layout->ctrl |= RT5682S_TDM_TX_CH_8;
+		layout->ctrl |= RT5682S_TDM_RX_CH_8;
 		break;
 	case 2:
 		break;
 	default:
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Invalid TDM slot count %d\n", slots);
 		return STATUS_INVALID_PARAMETER;
 	}
 
-	rt5682s_reg_update(pDevice, RT5682S_TDM_CTRL,
-		RT5682S_TDM_TX_CH_MASK | RT5682S_TDM_RX_CH_MASK |
-		RT5682S_TDM_ADC_DL_MASK, val);
+	if ((tx_mask | rx_mask) & ~((1U << slots) - 1)) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Slot masks beyond %d slots.\n", slots);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	/* Tx slot configuration */
+	if (tx_slotnum) {
+		unsigned int first = hweight_long((tx_mask & (0U - tx_mask)) - 1);
+		if (tx_slotnum > 4 || (tx_mask >> first) != (1U << tx_slotnum) - 1) {
+			RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Invalid or oversized Tx slots.\n");
+			return STATUS_INVALID_PARAMETER;
+		}
+		layout->ctrl |= first << RT5682S_TDM_ADC_LCA_SFT;
+		layout->ctrl |= (tx_slotnum - 1) << RT5682S_TDM_ADC_DL_SFT;
+	}
+
+	if (rx_mask & ~0x3U) {
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Rx slots must be within the first two.\n");
+		return STATUS_INVALID_PARAMETER;
+	}
 
 	switch (slot_width) {
 	case 8:
 		if (tx_mask || rx_mask)
 			return STATUS_INVALID_PARAMETER;
-		cl = RT5682S_I2S1_TX_CHL_8 | RT5682S_I2S1_RX_CHL_8;
+		layout->sdp = RT5682S_I2S1_TX_CHL_8 | RT5682S_I2S1_RX_CHL_8;
 		break;
 	case 16:
-		val = RT5682S_TDM_CL_16;
-		cl = RT5682S_I2S1_TX_CHL_16 | RT5682S_I2S1_RX_CHL_16;
+		layout->tcon = RT5682S_TDM_CL_16;
+		layout->sdp = RT5682S_I2S1_TX_CHL_16 | RT5682S_I2S1_RX_CHL_16;
 		break;
 	case 20:
-		val = RT5682S_TDM_CL_20;
-		cl = RT5682S_I2S1_TX_CHL_20 | RT5682S_I2S1_RX_CHL_20;
+		layout->tcon = RT5682S_TDM_CL_20;
+		layout->sdp = RT5682S_I2S1_TX_CHL_20 | RT5682S_I2S1_RX_CHL_20;
 		break;
 	case 24:
-		val = RT5682S_TDM_CL_24;
-		cl = RT5682S_I2S1_TX_CHL_24 | RT5682S_I2S1_RX_CHL_24;
+		layout->tcon = RT5682S_TDM_CL_24;
+		layout->sdp = RT5682S_I2S1_TX_CHL_24 | RT5682S_I2S1_RX_CHL_24;
 		break;
 	case 32:
-		val = RT5682S_TDM_CL_32;
-		cl = RT5682S_I2S1_TX_CHL_32 | RT5682S_I2S1_RX_CHL_32;
+		layout->tcon = RT5682S_TDM_CL_32;
+		layout->sdp = RT5682S_I2S1_TX_CHL_32 | RT5682S_I2S1_RX_CHL_32;
 		break;
 	default:
 		return STATUS_INVALID_PARAMETER;
 	}
 
-	rt5682s_reg_update(pDevice, RT5682S_TDM_TCON_CTRL_1,
-		RT5682S_TDM_CL_MASK, val);
-	rt5682s_reg_update(pDevice, RT5682S_I2S1_SDP,
-		RT5682S_I2S1_TX_CHL_MASK | RT5682S_I2S1_RX_CHL_MASK, cl);
-
 	return STATUS_SUCCESS;
 }
 
+static void rt5682s_batch_tdm_slot(struct rt5682s_batch* batch, const struct rt5682s_tdm_layout* layout)
+{
+	rt5682s_batch_update(batch, RT5682S_TDM_ADDA_CTRL_2, RT5682S_TDM_EN, layout->enable);
+	rt5682s_batch_update(batch, RT5682S_TDM_CTRL,
+		RT5682S_TDM_TX_CH_MASK | RT5682S_TDM_RX_CH_MASK |
+		RT5682S_TDM_ADC_LCA_MASK | RT5682S_TDM_ADC_DL_MASK, layout->ctrl);
+	rt5682s_batch_update(batch, RT5682S_TDM_TCON_CTRL_1,
+		RT5682S_TDM_CL_MASK, layout->tcon);
+	rt5682s_batch_update(batch, RT5682S_I2S1_SDP,
+		RT5682S_I2S1_TX_CHL_MASK | RT5682S_I2S1_RX_CHL_MASK, layout->sdp);
+}
+
+NTSTATUS rt5682s_set_tdm_slot(PRTEK_CONTEXT  pDevice, unsigned int tx_mask,
+	unsigned int rx_mask, int slots, int slot_width)
+{
+	struct rt5682s_tdm_layout layout;
+	struct rt5682s_batch batch;
+
+	NTSTATUS status = rt5682s_tdm_layout(tx_mask, rx_mask, slots, slot_width, &layout);
+	if (!NT_SUCCESS(status))
+		return status;
+
+	rt5682s_batch_begin(pDevice, &batch);
+	rt5682s_batch_tdm_slot(&batch, &layout);
+	return rt5682s_batch_commit(&batch);
+}
+
+//Moves the system clock and both I2S master clocks to src in one sequence
+static void rt5682s_batch_sysclk(struct rt5682s_batch* batch, unsigned int src)
+{
+	rt5682s_batch_update(batch, RT5682S_GLB_CLK,
+		RT5682S_SCLK_SRC_MASK, src << RT5682S_SCLK_SRC_SFT);
+	rt5682s_batch_update(batch, RT5682S_ADDA_CLK_1,
+		RT5682S_I2S_M_CLK_SRC_MASK, src << RT5682S_I2S_M_CLK_SRC_SFT);
+	rt5682s_batch_update(batch, RT5682S_I2S2_M_CLK_CTRL_1,
+		RT5682S_I2S2_M_CLK_SRC_MASK, src << RT5682S_I2S2_M_CLK_SRC_SFT);
+}
+
 NTSTATUS rt5682s_set_component_sysclk(PRTEK_CONTEXT  pDevice,
 	int clk_id)
 {
@@ -796,17 +2653,16 @@ NTSTATUS rt5682s_set_component_sysclk(PRTEK_CONTEXT  pDevice,
 		return STATUS_INVALID_PARAMETER;
 	}
 
-	rt5682s_reg_update(pDevice, RT5682S_GLB_CLK,
-		RT5682S_SCLK_SRC_MASK, src << RT5682S_SCLK_SRC_SFT);
-	rt5682s_reg_update(pDevice, RT5682S_ADDA_CLK_1,
-		RT5682S_I2S_M_CLK_SRC_MASK, src << RT5682S_I2S_M_CLK_SRC_SFT);
-	rt5682s_reg_update(pDevice, RT5682S_I2S2_M_CLK_CTRL_1,
-		RT5682S_I2S2_M_CLK_SRC_MASK, src << RT5682S_I2S2_M_CLK_SRC_SFT);
+	struct rt5682s_batch batch;
+
+	rt5682s_batch_begin(pDevice, &batch);
+	rt5682s_batch_sysclk(&batch, src);
+	NTSTATUS status = rt5682s_batch_commit(&batch);
 
 	RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP, "Sysclk is %dHz and clock id is %d\n",
 		freq, clk_id);
 
-	return STATUS_SUCCESS;
+	return status;
 }
 
 NTSTATUS
@@ -896,6 +2752,8 @@ Status
 		status = STATUS_NOT_FOUND;
 	}
 
+	rt5682s_load_boot_settings(pDevice);
+
 	status = SpbTargetInitialize(FxDevice, &pDevice->I2CContext);
 
 	if (!NT_SUCCESS(status))
@@ -903,6 +2761,9 @@ Status
 		return status;
 	}
 
+	rt5682s_load_calib_settings(pDevice);
+	rt5682s_load_init_tuning(pDevice);
+
 	return status;
 }
 
@@ -932,6 +2793,24 @@ Status
 
 	UNREFERENCED_PARAMETER(FxResourcesTranslated);
 
+#if DBG
+	if (pDevice->RegLockCount) {
+		LARGE_INTEGER freq;
+		KeQueryPerformanceCounter(&freq);
+		RtekStatPrint("Register lock held %u times, avg %lld us, max %lld us\n",
+			pDevice->RegLockCount,
+			pDevice->RegLockHoldTotal * 1000000 / pDevice->RegLockCount / freq.QuadPart,
+			pDevice->RegLockHoldMax * 1000000 / freq.QuadPart);
+	}
+#endif
+
+	RtekPrint(DEBUG_LEVEL_INFO, DBG_PNP,
+		"Fast resume hit %u times, missed %u times\n",
+		pDevice->ResumeHits, pDevice->ResumeMisses);
+
+	rt5682s_poll_report(pDevice);
+	rt5682s_free_init_tuning(pDevice);
+
 	SpbTargetDeinitialize(FxDevice, &pDevice->I2CContext);
 
 	if (pDevice->CSAudioAPICallbackObj) {
@@ -1016,14 +2895,44 @@ Status
 	NTSTATUS status = STATUS_SUCCESS;
 
 	pDevice->JackType = 0;
+	pDevice->BootStatus = STATUS_SUCCESS;
+	KeClearEvent(&pDevice->CodecReady);
+
+	rt5682s_prof_begin(pDevice);
+
+	//With AsyncBringUp only the reset and ID check hold up the power IRP
+	BOOLEAN resumed = NT_SUCCESS(RESUMECODEC(pDevice));
+	BOOLEAN pending = FALSE;
+	if (!resumed && pDevice->AsyncBringUp) {
+		status = rt5682s_boot_reset(pDevice);
+		if (NT_SUCCESS(status)) {
+			pending = NT_SUCCESS(RtekQueueBootWorkItem(FxDevice));
+			if (!pending)
+				status = rt5682s_boot_finish(pDevice);
+		}
+	}
+	else if (!resumed) {
+		status = BOOTCODEC(pDevice);
+	}
+
+	rt5682s_prof_d0(pDevice);
+	if (!pending) {
+		pDevice->BootStatus = status;
+		rt5682s_prof_end(pDevice, resumed);
+		KeSetEvent(&pDevice->CodecReady, IO_NO_INCREMENT, FALSE);
+	}
 
-	status = BOOTCODEC(pDevice);
 	if (!NT_SUCCESS(status)) {
 		return status;
 	}
 
 	pDevice->ConnectInterrupt = true;
 
+	//No jack interrupt fires if the codec kept its state, so check the jack now
+	if (resumed) {
+		RtekQueueJdetWorkItem(FxDevice);
+	}
+
 	RtekCompleteIdleIrp(pDevice);
 
 	return status;
@@ -1055,6 +2964,9 @@ Status
 
 	PRTEK_CONTEXT pDevice = GetDeviceContext(FxDevice);
 
+	//An asynchronous bring up has to finish before the codec powers down
+	KeWaitForSingleObject(&pDevice->CodecReady, Executive, KernelMode, FALSE, NULL);
+
 	pDevice->ConnectInterrupt = false;
 
 	return STATUS_SUCCESS;
@@ -1066,55 +2978,50 @@ enum {
 	SAR_PWR_SAVING,
 };
 
-static void rt5682s_sar_power_mode(PRTEK_CONTEXT pDevice, int mode)
+static void rt5682s_sar_power_mode(struct rt5682s_batch* batch, int mode)
 {
-	LARGE_INTEGER WaitInterval;
-
 	switch (mode) {
 	case SAR_PWR_SAVING:
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_3,
+		rt5682s_batch_update(batch, RT5682S_CBJ_CTRL_3,
 			RT5682S_CBJ_IN_BUF_MASK, RT5682S_CBJ_IN_BUF_DIS);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_MB1_PATH_MASK | RT5682S_MB2_PATH_MASK,
 			RT5682S_CTRL_MB1_REG | RT5682S_CTRL_MB2_REG);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK | RT5682S_SAR_BUTDET_POW_MASK |
 			RT5682S_SAR_SEL_MB1_2_CTL_MASK, RT5682S_SAR_BUTDET_DIS |
 			RT5682S_SAR_BUTDET_POW_SAV | RT5682S_SAR_SEL_MB1_2_MANU);
-		
-		WaitInterval.QuadPart = -10 * 1000 * 5;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
 
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_delay(batch, 5);
+
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK, RT5682S_SAR_BUTDET_EN);
 
-		WaitInterval.QuadPart = -10 * 1000 * 5;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+		rt5682s_batch_delay(batch, 5);
 
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_2,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_2,
 			RT5682S_SAR_ADC_PSV_MASK, RT5682S_SAR_ADC_PSV_ENTRY);
 		break;
 	case SAR_PWR_NORMAL:
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_3,
+		rt5682s_batch_update(batch, RT5682S_CBJ_CTRL_3,
 			RT5682S_CBJ_IN_BUF_MASK, RT5682S_CBJ_IN_BUF_EN);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_MB1_PATH_MASK | RT5682S_MB2_PATH_MASK,
 			RT5682S_CTRL_MB1_FSM | RT5682S_CTRL_MB2_FSM);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_SEL_MB1_2_CTL_MASK, RT5682S_SAR_SEL_MB1_2_AUTO);
-		
-		WaitInterval.QuadPart = -10 * 1000 * 5;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
 
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_delay(batch, 5);
+
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK | RT5682S_SAR_BUTDET_POW_MASK,
 			RT5682S_SAR_BUTDET_EN | RT5682S_SAR_BUTDET_POW_NORM);
 		break;
 	case SAR_PWR_OFF:
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_MB1_PATH_MASK | RT5682S_MB2_PATH_MASK,
 			RT5682S_CTRL_MB1_FSM | RT5682S_CTRL_MB2_FSM);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK | RT5682S_SAR_BUTDET_POW_MASK |
 			RT5682S_SAR_SEL_MB1_2_CTL_MASK, RT5682S_SAR_BUTDET_DIS |
 			RT5682S_SAR_BUTDET_POW_SAV | RT5682S_SAR_SEL_MB1_2_MANU);
@@ -1125,32 +3032,32 @@ static void rt5682s_sar_power_mode(PRTEK_CONTEXT pDevice, int mode)
 	}
 }
 
-static void rt5682s_enable_push_button_irq(PRTEK_CONTEXT pDevice,
+static void rt5682s_enable_push_button_irq(struct rt5682s_batch* batch,
 	bool enable)
 {
 
 	if (enable) {
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_13,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_13,
 			RT5682S_SAR_SOUR_MASK, RT5682S_SAR_SOUR_BTN);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK | RT5682S_SAR_BUTDET_POW_MASK |
 			RT5682S_SAR_SEL_MB1_2_CTL_MASK, RT5682S_SAR_BUTDET_EN |
 			RT5682S_SAR_BUTDET_POW_NORM | RT5682S_SAR_SEL_MB1_2_AUTO);
-		rt5682s_reg_write(pDevice, RT5682S_IL_CMD_1, 0x0040);
-		rt5682s_reg_update(pDevice, RT5682S_4BTN_IL_CMD_2,
+		rt5682s_batch_write(batch, RT5682S_IL_CMD_1, 0x0040);
+		rt5682s_batch_update(batch, RT5682S_4BTN_IL_CMD_2,
 			RT5682S_4BTN_IL_MASK | RT5682S_4BTN_IL_RST_MASK,
 			RT5682S_4BTN_IL_EN | RT5682S_4BTN_IL_NOR);
-		rt5682s_reg_update(pDevice, RT5682S_IRQ_CTRL_3,
+		rt5682s_batch_update(batch, RT5682S_IRQ_CTRL_3,
 			RT5682S_IL_IRQ_MASK, RT5682S_IL_IRQ_EN);
 	}
 	else {
-		rt5682s_reg_update(pDevice, RT5682S_IRQ_CTRL_3,
+		rt5682s_batch_update(batch, RT5682S_IRQ_CTRL_3,
 			RT5682S_IL_IRQ_MASK, RT5682S_IL_IRQ_DIS);
-		rt5682s_reg_update(pDevice, RT5682S_4BTN_IL_CMD_2,
+		rt5682s_batch_update(batch, RT5682S_4BTN_IL_CMD_2,
 			RT5682S_4BTN_IL_MASK, RT5682S_4BTN_IL_DIS);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_13,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_13,
 			RT5682S_SAR_SOUR_MASK, RT5682S_SAR_SOUR_TYPE);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+		rt5682s_batch_update(batch, RT5682S_SAR_IL_CMD_1,
 			RT5682S_SAR_BUTDET_MASK | RT5682S_SAR_BUTDET_POW_MASK |
 			RT5682S_SAR_SEL_MB1_2_CTL_MASK, RT5682S_SAR_BUTDET_DIS |
 			RT5682S_SAR_BUTDET_POW_SAV | RT5682S_SAR_SEL_MB1_2_MANU);
@@ -1158,88 +3065,90 @@ static void rt5682s_enable_push_button_irq(PRTEK_CONTEXT pDevice,
 }
 
 int rt5682s_headset_detect(PRTEK_CONTEXT pDevice, int jack_insert) {
-	UINT16 val, count;
+	struct rt5682s_batch batch;
+	UINT16 val;
 	if (jack_insert) {
-		rt5682s_enable_push_button_irq(pDevice, false);
+		rt5682s_batch_begin(pDevice, &batch);
 
-		rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_1,
+		rt5682s_enable_push_button_irq(&batch, false);
+
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_1,
 			RT5682S_PWR_VREF1 | RT5682S_PWR_VREF2 | RT5682S_PWR_MB,
 			RT5682S_PWR_VREF1 | RT5682S_PWR_VREF2 | RT5682S_PWR_MB);
-		rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_1,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_1,
 			RT5682S_PWR_FV1 | RT5682S_PWR_FV2, 0);
 
-		LARGE_INTEGER WaitInterval;
-		WaitInterval.QuadPart = -10 * 1000 * 15;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+		rt5682s_batch_delay(&batch, 15);
 
-		rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_1,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_1,
 			RT5682S_PWR_FV1 | RT5682S_PWR_FV2,
 			RT5682S_PWR_FV1 | RT5682S_PWR_FV2);
-		rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_3,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
 			RT5682S_PWR_CBJ, RT5682S_PWR_CBJ);
-		rt5682s_reg_write(pDevice, RT5682S_SAR_IL_CMD_3, 0x0365);
-		rt5682s_reg_update(pDevice, RT5682S_HP_CHARGE_PUMP_2,
+		rt5682s_batch_write(&batch, RT5682S_SAR_IL_CMD_3, 0x0365);
+		rt5682s_batch_update(&batch, RT5682S_HP_CHARGE_PUMP_2,
 			RT5682S_OSW_L_MASK | RT5682S_OSW_R_MASK,
 			RT5682S_OSW_L_DIS | RT5682S_OSW_R_DIS);
-		rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_13,
+		rt5682s_batch_update(&batch, RT5682S_SAR_IL_CMD_13,
 			RT5682S_SAR_SOUR_MASK, RT5682S_SAR_SOUR_TYPE);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_3,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_3,
 			RT5682S_CBJ_IN_BUF_MASK, RT5682S_CBJ_IN_BUF_EN);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_TRIG_JD_MASK, RT5682S_TRIG_JD_LOW);
 
-		WaitInterval.QuadPart = -10 * 1000 * 45;
-		KeDelayExecutionThread(KernelMode, false, &WaitInterval);
+		rt5682s_batch_delay(&batch, 45);
 
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_TRIG_JD_MASK, RT5682S_TRIG_JD_HIGH);
 
-		count = 0;
-		rt5682s_reg_read(pDevice, RT5682S_CBJ_CTRL_2, &val);
+		rt5682s_batch_commit(&batch);
+
+		rt5682s_poll_reg(pDevice, RT5682S_POLL_JACK_TYPE, RT5682S_CBJ_CTRL_2,
+			RT5682S_JACK_TYPE_MASK, 0, FALSE, &val);
 		val &= RT5682S_JACK_TYPE_MASK;
-		while (val == 0 && count < 50) {
-			WaitInterval.QuadPart = -10 * 1000 * 15;
-			KeDelayExecutionThread(KernelMode, false, &WaitInterval);
 
-			rt5682s_reg_read(pDevice, RT5682S_CBJ_CTRL_2, &val);
-			val &= RT5682S_JACK_TYPE_MASK;
-			count++;
-		}
+		rt5682s_batch_begin(pDevice, &batch);
 
 		switch (val) {
 		case 0x1:
 		case 0x2:
 			pDevice->JackType = SND_JACK_HEADSET;
-			rt5682s_reg_write(pDevice, RT5682S_SAR_IL_CMD_3, 0x024c);
-			rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+			rt5682s_batch_write(&batch, RT5682S_SAR_IL_CMD_3, 0x024c);
+			rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 				RT5682S_FAST_OFF_MASK, RT5682S_FAST_OFF_EN);
-			rt5682s_reg_update(pDevice, RT5682S_SAR_IL_CMD_1,
+			rt5682s_batch_update(&batch, RT5682S_SAR_IL_CMD_1,
 				RT5682S_SAR_SEL_MB1_2_MASK, val << RT5682S_SAR_SEL_MB1_2_SFT);
 
-			rt5682s_enable_push_button_irq(pDevice, true);
-			rt5682s_sar_power_mode(pDevice, SAR_PWR_NORMAL);
+			rt5682s_enable_push_button_irq(&batch, true);
+			rt5682s_sar_power_mode(&batch, SAR_PWR_NORMAL);
 			break;
 		default:
 			pDevice->JackType = SND_JACK_HEADPHONE;
 		}
 
-		rt5682s_reg_update(pDevice, RT5682S_HP_CHARGE_PUMP_2,
+		rt5682s_batch_update(&batch, RT5682S_HP_CHARGE_PUMP_2,
 			RT5682S_OSW_L_MASK | RT5682S_OSW_R_MASK,
 			RT5682S_OSW_L_EN | RT5682S_OSW_R_EN);
+
+		rt5682s_batch_commit(&batch);
 	}
 	else {
-		rt5682s_sar_power_mode(pDevice, SAR_PWR_OFF);
-		rt5682s_enable_push_button_irq(pDevice, false);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_begin(pDevice, &batch);
+
+		rt5682s_sar_power_mode(&batch, SAR_PWR_OFF);
+		rt5682s_enable_push_button_irq(&batch, false);
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_TRIG_JD_MASK, RT5682S_TRIG_JD_LOW);
 
-		rt5682s_reg_update(pDevice, RT5682S_PWR_ANLG_3,
+		rt5682s_batch_update(&batch, RT5682S_PWR_ANLG_3,
 			RT5682S_PWR_CBJ, 0);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_1,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_1,
 			RT5682S_FAST_OFF_MASK, RT5682S_FAST_OFF_DIS);
-		rt5682s_reg_update(pDevice, RT5682S_CBJ_CTRL_3,
+		rt5682s_batch_update(&batch, RT5682S_CBJ_CTRL_3,
 			RT5682S_CBJ_IN_BUF_MASK, RT5682S_CBJ_IN_BUF_DIS);
 
+		rt5682s_batch_commit(&batch);
+
 		pDevice->JackType = 0;
 	}
 
@@ -1352,6 +3261,9 @@ RtekJdetWorkItem(
 	WDFDEVICE Device = (WDFDEVICE)WdfWorkItemGetParentObject(WorkItem);
 	PRTEK_CONTEXT pDevice = GetDeviceContext(Device);
 
+	if (!rt5682s_wait_ready(pDevice))
+		return;
+
 	rt5682s_jackdetect(pDevice);
 
 	if (GetPlatform() == PlatformRyzenCezanne) { //Speakers are managed by jack driver on Cezanne
@@ -1364,33 +3276,111 @@ RtekJdetWorkItem(
 	}
 }
 
-BOOLEAN OnInterruptIsr(
-	WDFINTERRUPT Interrupt,
-	ULONG MessageID) {
-	UNREFERENCED_PARAMETER(MessageID);
+void RtekQueueJdetWorkItem(WDFDEVICE Device) {
+	WDF_OBJECT_ATTRIBUTES attributes;
+	WDF_WORKITEM_CONFIG workitemConfig;
+	WDFWORKITEM hWorkItem;
 
-	WDFDEVICE Device = WdfInterruptGetDevice(Interrupt);
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	WDF_OBJECT_ATTRIBUTES_SET_CONTEXT_TYPE(&attributes, RTEK_CONTEXT);
+	attributes.ParentObject = Device;
+	WDF_WORKITEM_CONFIG_INIT(&workitemConfig, RtekJdetWorkItem);
+
+	WdfWorkItemCreate(&workitemConfig,
+		&attributes,
+		&hWorkItem);
+
+	WdfWorkItemEnqueue(hWorkItem);
+}
+
+VOID
+RtekBootWorkItem(
+	IN WDFWORKITEM  WorkItem
+)
+{
+	WDFDEVICE Device = (WDFDEVICE)WdfWorkItemGetParentObject(WorkItem);
 	PRTEK_CONTEXT pDevice = GetDeviceContext(Device);
 
-	if (!pDevice->ConnectInterrupt)
-		return true;
+	rt5682s_prof_attach(pDevice);
+	pDevice->BootStatus = rt5682s_boot_finish(pDevice);
+	rt5682s_prof_end(pDevice, FALSE);
 
-	NTSTATUS status = STATUS_SUCCESS;
+	KeSetEvent(&pDevice->CodecReady, IO_NO_INCREMENT, FALSE);
+
+	if (!NT_SUCCESS(pDevice->BootStatus)) {
+		DbgPrint("Codec bring up failed 0x%x\n", pDevice->BootStatus);
+		WdfDeviceSetFailed(Device, WdfDeviceFailedAttemptRestart);
+	}
+
+	//Every asynchronous D0 entry queues a new one
+	WdfObjectDelete(WorkItem);
+}
 
+NTSTATUS RtekQueueBootWorkItem(WDFDEVICE Device) {
 	WDF_OBJECT_ATTRIBUTES attributes;
 	WDF_WORKITEM_CONFIG workitemConfig;
 	WDFWORKITEM hWorkItem;
 
 	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-	WDF_OBJECT_ATTRIBUTES_SET_CONTEXT_TYPE(&attributes, RTEK_CONTEXT);
 	attributes.ParentObject = Device;
-	WDF_WORKITEM_CONFIG_INIT(&workitemConfig, RtekJdetWorkItem);
+	WDF_WORKITEM_CONFIG_INIT(&workitemConfig, RtekBootWorkItem);
 
-	WdfWorkItemCreate(&workitemConfig,
+	NTSTATUS status = WdfWorkItemCreate(&workitemConfig,
 		&attributes,
 		&hWorkItem);
+	if (!NT_SUCCESS(status)) {
+		return status;
+	}
+
+	WdfWorkItemEnqueue(hWorkItem);
+	return STATUS_SUCCESS;
+}
+
+//Applies a reclock requested above APC_LEVEL once the codec is up
+VOID
+RtekReclockWorkItem(
+	IN WDFWORKITEM  WorkItem
+)
+{
+	WDFDEVICE Device = (WDFDEVICE)WdfWorkItemGetParentObject(WorkItem);
+	PRTEK_CONTEXT pDevice = GetDeviceContext(Device);
+
+	if (rt5682s_wait_ready(pDevice))
+		rt5682s_update_reclock(pDevice);
+
+	WdfObjectDelete(WorkItem);
+}
+
+void RtekQueueReclockWorkItem(WDFDEVICE Device) {
+	WDF_OBJECT_ATTRIBUTES attributes;
+	WDF_WORKITEM_CONFIG workitemConfig;
+	WDFWORKITEM hWorkItem;
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = Device;
+	WDF_WORKITEM_CONFIG_INIT(&workitemConfig, RtekReclockWorkItem);
+
+	if (!NT_SUCCESS(WdfWorkItemCreate(&workitemConfig,
+		&attributes,
+		&hWorkItem))) {
+		return;
+	}
 
 	WdfWorkItemEnqueue(hWorkItem);
+}
+
+BOOLEAN OnInterruptIsr(
+	WDFINTERRUPT Interrupt,
+	ULONG MessageID) {
+	UNREFERENCED_PARAMETER(MessageID);
+
+	WDFDEVICE Device = WdfInterruptGetDevice(Interrupt);
+	PRTEK_CONTEXT pDevice = GetDeviceContext(Device);
+
+	if (!pDevice->ConnectInterrupt)
+		return true;
+
+	RtekQueueJdetWorkItem(Device);
 
 	return true;
 }
@@ -1496,6 +3486,25 @@ Rt5682EvtDeviceAdd(
 
 	devContext->ReclockRequested = FALSE;
 
+	KeInitializeEvent(&devContext->CodecReady, NotificationEvent, TRUE);
+
+	//
+	// Create the lock guarding the register cache
+	//
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = device;
+
+	status = WdfWaitLockCreate(&attributes, &devContext->RegCacheLock);
+
+	if (!NT_SUCCESS(status))
+	{
+		RtekPrint(DEBUG_LEVEL_ERROR, DBG_PNP,
+			"WdfWaitLockCreate failed 0x%x\n", status);
+
+		return status;
+	}
+
 	WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchManual);
 
 	queueConfig.PowerManaged = WdfFalse;
@@ -2521,6 +4530,26 @@ Rt5682GetFeature(
 
 			switch (transferPacket->reportId)
 			{
+#if RT5682S_PROFILE
+			case REPORTID_PROFILE:
+
+				if (transferPacket->reportBufferLen < sizeof(Rt5682ProfileReport))
+				{
+					RtekPrint(DEBUG_LEVEL_ERROR, DBG_IOCTL,
+						"Rt5682GetFeature Profile report buffer too small\n");
+
+					status = STATUS_BUFFER_TOO_SMALL;
+
+					break;
+				}
+
+				RtlCopyMemory(transferPacket->reportBuffer, &DevContext->Profiler.Summary, sizeof(Rt5682ProfileReport));
+				((Rt5682ProfileReport*)transferPacket->reportBuffer)->ReportID = REPORTID_PROFILE;
+
+				WdfRequestSetInformation(Request, sizeof(Rt5682ProfileReport));
+
+				break;
+#endif
 			default:
 
 				RtekPrint(DEBUG_LEVEL_ERROR, DBG_IOCTL,
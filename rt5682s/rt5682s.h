@@ -18,6 +18,7 @@
 
 #include "hidcommon.h"
 #include "spb.h"
+#include "registers.h"
 #include <stdint.h>
 
 #define true 1
@@ -100,6 +101,18 @@ struct reg {
 
 	typedef UCHAR HID_REPORT_DESCRIPTOR, *PHID_REPORT_DESCRIPTOR;
 
+//
+// Boot timeline profiler, checked builds only. Every bus transfer, delay
+// and poll sleep of the last D0 entry lands in a ring of
+// RT5682S_PROF_RING_SIZE events, timed with the performance counter, and
+// the summary is exposed as the REPORTID_PROFILE feature report.
+//
+#if DBG
+#define RT5682S_PROFILE 1
+#else
+#define RT5682S_PROFILE 0
+#endif
+
 #ifdef DESCRIPTOR_DEF
 HID_REPORT_DESCRIPTOR DefaultReportDescriptor[] = {
 	//
@@ -138,6 +151,20 @@ HID_REPORT_DESCRIPTOR DefaultReportDescriptor[] = {
 	0x09, 0x02,                          //   USAGE (Vendor Usage 1)
 	0x91, 0x02,                          //   OUTPUT (Data,Var,Abs)
 	0xc0,                                // END_COLLECTION
+
+#if RT5682S_PROFILE
+	0x06, 0x00, 0xff,                    // USAGE_PAGE (Vendor Defined Page 1)
+	0x09, 0x05,                          // USAGE (Vendor Usage 5)
+	0xa1, 0x01,                          // COLLECTION (Application)
+	0x85, REPORTID_PROFILE,              //   REPORT_ID (Profile)
+	0x15, 0x00,                          //   LOGICAL_MINIMUM (0)
+	0x26, 0xff, 0x00,                    //   LOGICAL_MAXIMUM (256)
+	0x75, 0x08,                          //   REPORT_SIZE  (8)   - bits
+	0x95, sizeof(Rt5682ProfileReport) - 1, //   REPORT_COUNT (Profile report) - Bytes
+	0x09, 0x06,                          //   USAGE (Vendor Usage 6)
+	0xb1, 0x02,                          //   FEATURE (Data,Var,Abs)
+	0xc0,                                // END_COLLECTION
+#endif
 };
 
 
@@ -158,6 +185,106 @@ CONST HID_DESCRIPTOR DefaultHidDescriptor = {
 };
 #endif
 
+#define RT5682S_CALIB_ST_COUNT (RT5682S_HP_CALIB_ST_11 - RT5682S_HP_CALIB_ST_1 + 1)
+#define RT5682S_SIGNATURE_COUNT (RT5682S_DUMMY_3 - RT5682S_DUMMY_1 + 1)
+
+#define RT5682S_PLL_CTRL_COUNT (RT5682S_PLL_CTRL_7 - RT5682S_PLL_CTRL_1 + 1)
+#define RT5682S_PLL_CACHE_SIZE 8	//Power of two
+#define RT5682S_PLL_MAX_ERR_PPB 100000	//Largest error Settings\PllMaxErrorPpb may allow
+
+//PLL_CTRL_1..7 fields for one conversion, comb is -1 if no divider fits
+struct rt5682s_pll_config {
+	int pll_id;
+	unsigned int freq_in;
+	unsigned int freq_out;
+	int comb;
+	UINT16 masks[RT5682S_PLL_CTRL_COUNT];
+	UINT16 vals[RT5682S_PLL_CTRL_COUNT];
+	UINT32 errPpb;
+};
+
+//Clock configuration rt5682s_update_reclock has programmed, src is the RT5682S_CLK_SRC_* sysclk runs from
+struct rt5682s_clock_state {
+	BOOLEAN valid;
+	UINT32 mclk;
+	UINT32 outclk;
+	int src;
+	UINT32 slotWidth;
+	UINT32 tdmSlots;
+	UINT32 txMask;
+	UINT32 rxMask;
+};
+
+//TDM_ADDA_CTRL_2, TDM_CTRL, TDM_TCON_CTRL_1 and I2S1_SDP fields of a validated slot layout
+struct rt5682s_tdm_layout {
+	UINT16 enable;
+	UINT16 ctrl;
+	UINT16 tcon;
+	UINT16 sdp;
+};
+
+//Register poll call sites, each learns its own settle time
+enum {
+	RT5682S_POLL_CALIB,
+	RT5682S_POLL_JACK_TYPE,
+	RT5682S_POLL_SITE_COUNT
+};
+
+struct rt5682s_poll_stats {
+	UINT32 estimateMs;	//Running average of the settle time
+	UINT32 count;
+	UINT32 timeouts;
+	UINT32 maxMs;
+	UINT64 totalMs;
+};
+
+//Settings\HpCalibrationPolicy
+typedef enum {
+	CalibPolicyReuse = 0,	//Skip calibration while the codec still reports the saved result
+	CalibPolicyAlways = 1	//Calibrate after every codec reset, the default
+} CalibPolicy;
+
+#define RT5682S_PROF_RING_SIZE 512
+
+typedef enum {
+	ProfEventWrite,
+	ProfEventRead,
+	ProfEventBlockWrite,
+	ProfEventBlockRead,
+	ProfEventBurst,
+	ProfEventDelay,
+	ProfEventPoll,
+	ProfEventCount
+} ProfEventType;
+
+typedef struct _RT5682S_PROF_EVENT
+{
+	LONGLONG Start;
+	ULONG Ticks;
+	UINT16 Reg;
+	UINT16 Value;	//Data, or word count for block and burst transfers
+	UCHAR Type;
+	UCHAR Phase;
+} RT5682S_PROF_EVENT;
+
+typedef struct _RT5682S_PROFILER
+{
+	RT5682S_PROF_EVENT Ring[RT5682S_PROF_RING_SIZE];
+	LONG Next;
+	LONG First;
+	PKTHREAD Thread;
+	UCHAR Phase;
+	LONGLONG Frequency;
+	LONGLONG Start;
+	LONGLONG PhaseStart;
+	LONGLONG D0Ticks;
+	LONGLONG PhaseTicks[PROFILE_PHASE_COUNT];
+	LONGLONG PhaseBusTicks[PROFILE_PHASE_COUNT];
+	LONGLONG PhaseWaitTicks[PROFILE_PHASE_COUNT];
+	ULONG PhaseOps[PROFILE_PHASE_COUNT];
+	Rt5682ProfileReport Summary;
+} RT5682S_PROFILER;
+
 typedef struct _RTEK_CONTEXT
 {
 
@@ -186,6 +313,48 @@ typedef struct _RTEK_CONTEXT
 	UINT32 mclk;
 	UINT32 freq;
 	UINT32 slotWidth;
+	UINT32 tdmSlots;
+	UINT32 txMask;
+	UINT32 rxMask;
+	struct rt5682s_clock_state ClockApplied;
+
+	WDFWAITLOCK RegCacheLock;
+#if DBG
+	LARGE_INTEGER RegLockAcquired;
+	LONGLONG RegLockHoldTotal;
+	LONGLONG RegLockHoldMax;
+	ULONG RegLockCount;
+#endif
+	UINT16 RegCache[RT5682S_REG_COUNT];
+	ULONG RegCacheValid[(RT5682S_REG_COUNT + 31) / 32];
+	BOOLEAN BlockProbed;
+	BOOLEAN BlockAutoInc;
+
+	BOOLEAN RegImageSaved;
+	UINT16 ResumeSignature[RT5682S_SIGNATURE_COUNT];
+	ULONG ResumeHits;
+	ULONG ResumeMisses;
+	UINT16 RegImage[RT5682S_REG_COUNT];
+	ULONG RegImageValid[(RT5682S_REG_COUNT + 31) / 32];
+	UINT16 CalibState[RT5682S_CALIB_ST_COUNT];
+	BOOLEAN CalibSaved;
+	CalibPolicy HpCalibPolicy;
+
+	struct rt5682s_poll_stats PollStats[RT5682S_POLL_SITE_COUNT];
+
+	PVOID TuningOps;
+	int TuningOpCount;
+
+	struct rt5682s_pll_config PllCache[RT5682S_PLL_CACHE_SIZE];
+	UINT32 PllMaxErrPpb;	//Settings\PllMaxErrorPpb, 0 accepts exact dividers only
+
+	BOOLEAN AsyncBringUp;
+	KEVENT CodecReady;
+	NTSTATUS BootStatus;
+
+#if RT5682S_PROFILE
+	RT5682S_PROFILER Profiler;
+#endif
 
 } RTEK_CONTEXT, *PRTEK_CONTEXT;
 
@@ -312,4 +481,15 @@ RtekCompleteIdleIrp(
 }
 #endif
 
+//
+// Driver statistics stay visible in checked builds even though RtekPrint
+// is compiled out. Enable them with the IHVAUDIO debug filter.
+//
+#if DBG
+#define RtekStatPrint(fmt, ...) \
+	DbgPrintEx(DPFLTR_IHVAUDIO_ID, DPFLTR_INFO_LEVEL, DRIVERNAME fmt, __VA_ARGS__)
+#else
+#define RtekStatPrint(fmt, ...)
+#endif
+
 #endif
\ No newline at end of file
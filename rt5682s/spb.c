@@ -26,83 +26,177 @@ Revision History:
 static ULONG Rt5682DebugLevel = 100;
 static ULONG Rt5682DebugCatagories = DBG_INIT || DBG_PNP || DBG_IOCTL;
 
-NTSTATUS
-SpbDoWriteDataSynchronously(
-	IN SPB_CONTEXT* SpbContext,
-	IN PVOID Data,
-	IN ULONG Length
+typedef struct _SPB_TRANSFER {
+	SPB_TRANSFER_LIST List;
+	SPB_TRANSFER_LIST_ENTRY ExtraTransfers[];
+} SPB_TRANSFER;
+
+#define SPB_TRANSFER_SIZE(count) \
+	(sizeof(SPB_TRANSFER) + (sizeof(SPB_TRANSFER_LIST_ENTRY) * ((count) - 1)))
+
+static VOID
+SpbAsyncRelease(
+	IN SPB_ASYNC_REQUEST* AsyncRequest
 )
-/*++
+{
+	SPB_CONTEXT* SpbContext = AsyncRequest->SpbContext;
+	LONG bit = 1L << (LONG)(AsyncRequest - SpbContext->AsyncRequests);
 
-Routine Description:
+	AsyncRequest->Completion = NULL;
+	AsyncRequest->CompletionContext = NULL;
 
-This helper routine abstracts creating and sending an I/O
-request (I2C Write) to the Spb I/O target.
+	NT_ASSERT(SpbContext->AsyncInUse & bit);
+	InterlockedAnd(&SpbContext->AsyncInUse, ~bit);
+	KeReleaseSemaphore(&SpbContext->AsyncSlots, IO_NO_INCREMENT, 1, FALSE);
+}
 
-Arguments:
+EVT_WDF_REQUEST_COMPLETION_ROUTINE SpbAsyncRequestCompleted;
 
-SpbContext - Pointer to the current device context
-Address    - The I2C register address to write to
-Data       - A buffer to receive the data at at the above address
-Length     - The amount of data to be read from the above address
+static VOID
+SpbAsyncRequestCompleted(
+	IN WDFREQUEST Request,
+	IN WDFIOTARGET Target,
+	IN PWDF_REQUEST_COMPLETION_PARAMS Params,
+	IN WDFCONTEXT Context
+)
+{
+	SPB_ASYNC_REQUEST* asyncRequest = (SPB_ASYNC_REQUEST*)Context;
+	PSPB_ASYNC_COMPLETION completion = asyncRequest->Completion;
+	PVOID completionContext = asyncRequest->CompletionContext;
+	NTSTATUS status = Params->IoStatus.Status;
+	ULONG_PTR bytesTransferred = Params->IoStatus.Information;
 
-Return Value:
+	UNREFERENCED_PARAMETER(Request);
+	UNREFERENCED_PARAMETER(Target);
 
-NTSTATUS Status indicating success or failure
+	//
+	// The slot stays taken until the completion routine returns, so
+	// SpbTargetDeinitialize cannot reclaim it and delete the request first
+	//
+	if (completion != NULL)
+	{
+		completion(status, bytesTransferred, completionContext);
+	}
 
+	SpbAsyncRelease(asyncRequest);
+}
+
+NTSTATUS
+SpbSendSequenceAsync(
+	IN SPB_CONTEXT* SpbContext,
+	IN SPB_BURST_INFO* Writes,
+	IN ULONG WriteCount,
+	IN PVOID ReadData,
+	IN ULONG ReadLength,
+	IN PSPB_ASYNC_COMPLETION Completion,
+	IN PVOID Context
+)
+/*++
+Routine Description:
+This routine sends a list of writes, optionally followed by one read,
+to the Spb I/O target as a single IOCTL_SPB_EXECUTE_SEQUENCE without
+waiting for it. When every request slot is in flight the caller waits
+for one to complete. The write data is copied before this returns;
+ReadData must stay valid until Completion runs.
+Arguments:
+SpbContext - Pointer to the current device context
+Writes     - The writes to send, in order, at most
+             DEFAULT_SPB_ASYNC_DATA_SIZE bytes in total
+WriteCount - The number of writes, at most MaxSequenceTransfers
+ReadData   - A buffer to receive data after the writes, or NULL
+ReadLength - The amount of data to read
+Completion - Routine called when the sequence completes, or NULL
+Context    - Passed to Completion
+Return Value:
+NTSTATUS Status indicating whether the sequence was submitted.
+Completion runs only when this returns success.
 --*/
 {
-	PUCHAR buffer;
-	ULONG length;
-	WDFMEMORY memory;
-	WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+	SPB_ASYNC_REQUEST* asyncRequest = NULL;
+	ULONG transferCount = WriteCount + (ReadLength ? 1 : 0);
+	SIZE_T dataLength = 0;
 	NTSTATUS status;
 
-	length = Length;
-	memory = NULL;
+	for (ULONG i = 0; i < WriteCount; i++)
+	{
+		dataLength += Writes[i].Length;
+	}
 
-	if (length > DEFAULT_SPB_BUFFER_SIZE)
+	if (transferCount == 0 ||
+		WriteCount > SpbContext->MaxSequenceTransfers ||
+		dataLength > DEFAULT_SPB_ASYNC_DATA_SIZE ||
+		(ReadLength && ReadData == NULL))
 	{
-		status = WdfMemoryCreate(
-			WDF_NO_OBJECT_ATTRIBUTES,
-			NonPagedPool,
-			RT5682_POOL_TAG,
-			length,
-			&memory,
-			(PVOID*)&buffer);
+		return STATUS_INVALID_PARAMETER;
+	}
 
-		if (!NT_SUCCESS(status))
+	KeWaitForSingleObject(&SpbContext->AsyncSlots, Executive, KernelMode, FALSE, NULL);
+
+	for (;;)
+	{
+		LONG inUse = SpbContext->AsyncInUse;
+		ULONG index;
+
+		for (index = 0; index < SpbContext->AsyncDepth; index++)
 		{
-			RtekPrint(
-				DEBUG_LEVEL_ERROR,
-				DBG_IOCTL,
-				"Error allocating memory for Spb write - %!STATUS!",
-				status);
-			goto exit;
+			if (!(inUse & (1L << index)))
+				break;
 		}
 
-		WDF_MEMORY_DESCRIPTOR_INIT_HANDLE(
-			&memoryDescriptor,
-			memory,
-			NULL);
+		NT_ASSERT(index < SpbContext->AsyncDepth);
+
+		if (InterlockedCompareExchange(&SpbContext->AsyncInUse,
+			inUse | (1L << index), inUse) == inUse)
+		{
+			asyncRequest = &SpbContext->AsyncRequests[index];
+			break;
+		}
 	}
-	else
+
+	PUCHAR data = asyncRequest->Buffer + SpbContext->AsyncDataOffset;
+
+	SPB_TRANSFER* seq = (SPB_TRANSFER*)asyncRequest->Buffer;
+	SPB_TRANSFER_LIST_INIT(&(seq->List), transferCount);
+
+	for (ULONG i = 0; i < WriteCount; i++)
 	{
-		buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->WriteMemory, NULL);
+		RtlCopyMemory(data, Writes[i].Data, Writes[i].Length);
 
-		WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
-			&memoryDescriptor,
-			(PVOID)buffer,
-			length);
+		seq->List.Transfers[i] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+			SpbTransferDirectionToDevice,
+			0,
+			data,
+			Writes[i].Length);
+
+		data += Writes[i].Length;
+	}
+
+	if (ReadLength)
+	{
+		seq->List.Transfers[WriteCount] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+			SpbTransferDirectionFromDevice,
+			0,
+			ReadData,
+			ReadLength);
 	}
 
-	RtlCopyMemory(buffer, Data, length);
+	asyncRequest->Completion = Completion;
+	asyncRequest->CompletionContext = Context;
+
+	WDF_REQUEST_REUSE_PARAMS reuseParams;
+	WDF_REQUEST_REUSE_PARAMS_INIT(&reuseParams, WDF_REQUEST_REUSE_NO_FLAGS, STATUS_SUCCESS);
+	WdfRequestReuse(asyncRequest->Request, &reuseParams);
 
-	status = WdfIoTargetSendWriteSynchronously(
+	WDFMEMORY_OFFSET memoryOffset;
+	memoryOffset.BufferOffset = 0;
+	memoryOffset.BufferLength = SPB_TRANSFER_SIZE(transferCount);
+
+	status = WdfIoTargetFormatRequestForIoctl(
 		SpbContext->SpbIoTarget,
-		NULL,
-		&memoryDescriptor,
-		NULL,
+		asyncRequest->Request,
+		IOCTL_SPB_EXECUTE_SEQUENCE,
+		asyncRequest->Memory,
+		&memoryOffset,
 		NULL,
 		NULL);
 
@@ -111,21 +205,124 @@ NTSTATUS Status indicating success or failure
 		RtekPrint(
 			DEBUG_LEVEL_ERROR,
 			DBG_IOCTL,
-			"Error writing to Spb - %!STATUS!",
+			"Error formatting Spb sequence - %!STATUS!",
 			status);
-		goto exit;
+		SpbAsyncRelease(asyncRequest);
+		return status;
 	}
 
-exit:
+	WdfRequestSetCompletionRoutine(
+		asyncRequest->Request,
+		SpbAsyncRequestCompleted,
+		asyncRequest);
 
-	if (NULL != memory)
+	if (!WdfRequestSend(asyncRequest->Request, SpbContext->SpbIoTarget, WDF_NO_SEND_OPTIONS))
 	{
-		WdfObjectDelete(memory);
+		status = WdfRequestGetStatus(asyncRequest->Request);
+		RtekPrint(
+			DEBUG_LEVEL_ERROR,
+			DBG_IOCTL,
+			"Error sending Spb sequence - %!STATUS!",
+			status);
+		SpbAsyncRelease(asyncRequest);
+		return status;
+	}
+
+	return STATUS_SUCCESS;
+}
+
+//
+// The synchronous helpers submit through SpbSendSequenceAsync and wait.
+// Pending holds one reference for the submitter and one per sequence in
+// flight; the first failing status is kept.
+//
+typedef struct _SPB_SYNC_WAIT {
+	KEVENT Event;
+	volatile LONG Pending;
+	volatile LONG Status;
+	ULONG_PTR BytesTransferred;
+} SPB_SYNC_WAIT;
+
+static VOID
+SpbSyncWaitInit(
+	IN SPB_SYNC_WAIT* Wait
+)
+{
+	KeInitializeEvent(&Wait->Event, NotificationEvent, FALSE);
+	Wait->Pending = 1;
+	Wait->Status = STATUS_SUCCESS;
+	Wait->BytesTransferred = 0;
+}
+
+static VOID
+SpbSyncWaitDone(
+	IN SPB_SYNC_WAIT* Wait,
+	IN NTSTATUS Status
+)
+{
+	if (!NT_SUCCESS(Status))
+	{
+		InterlockedCompareExchange(&Wait->Status, Status, STATUS_SUCCESS);
+	}
+
+	if (InterlockedDecrement(&Wait->Pending) == 0)
+	{
+		KeSetEvent(&Wait->Event, IO_NO_INCREMENT, FALSE);
+	}
+}
+
+static VOID
+SpbSyncCompletion(
+	_In_ NTSTATUS Status,
+	_In_ ULONG_PTR BytesTransferred,
+	_In_opt_ PVOID Context
+)
+{
+	SPB_SYNC_WAIT* wait = (SPB_SYNC_WAIT*)Context;
+
+	wait->BytesTransferred = BytesTransferred;
+	SpbSyncWaitDone(wait, Status);
+}
+
+static NTSTATUS
+SpbSyncWaitSubmit(
+	IN SPB_CONTEXT* SpbContext,
+	IN SPB_SYNC_WAIT* Wait,
+	IN SPB_BURST_INFO* Writes,
+	IN ULONG WriteCount,
+	IN PVOID ReadData,
+	IN ULONG ReadLength
+)
+{
+	InterlockedIncrement(&Wait->Pending);
+
+	NTSTATUS status = SpbSendSequenceAsync(
+		SpbContext,
+		Writes,
+		WriteCount,
+		ReadData,
+		ReadLength,
+		SpbSyncCompletion,
+		Wait);
+
+	if (!NT_SUCCESS(status))
+	{
+		SpbSyncWaitDone(Wait, status);
 	}
 
 	return status;
 }
 
+static NTSTATUS
+SpbSyncWaitFinish(
+	IN SPB_SYNC_WAIT* Wait
+)
+{
+	SpbSyncWaitDone(Wait, STATUS_SUCCESS);
+	KeWaitForSingleObject(&Wait->Event, Executive, KernelMode, FALSE, NULL);
+	return (NTSTATUS)Wait->Status;
+}
+
 NTSTATUS
 SpbWriteDataSynchronously(
 	IN SPB_CONTEXT* SpbContext,
@@ -137,15 +334,14 @@ SpbWriteDataSynchronously(
 Routine Description:
 
 This routine abstracts creating and sending an I/O
-request (I2C Write) to the Spb I/O target and utilizes
-a helper routine to do work inside of locked code.
+request (I2C Write) to the Spb I/O target and waits
+for it to complete.
 
 Arguments:
 
 SpbContext - Pointer to the current device context
-Address    - The I2C register address to write to
-Data       - A buffer to receive the data at at the above address
-Length     - The amount of data to be read from the above address
+Data       - The address and data bytes to write
+Length     - The number of bytes to write
 
 Return Value:
 
@@ -153,16 +349,25 @@ NTSTATUS Status indicating success or failure
 
 --*/
 {
+	SPB_BURST_INFO write;
+	SPB_SYNC_WAIT wait;
 	NTSTATUS status;
 
-	WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+	write.Data = Data;
+	write.Length = Length;
 
-	status = SpbDoWriteDataSynchronously(
-		SpbContext,
-		Data,
-		Length);
+	SpbSyncWaitInit(&wait);
+	SpbSyncWaitSubmit(SpbContext, &wait, &write, 1, NULL, 0);
+	status = SpbSyncWaitFinish(&wait);
 
-	WdfWaitLockRelease(SpbContext->SpbLock);
+	if (!NT_SUCCESS(status))
+	{
+		RtekPrint(
+			DEBUG_LEVEL_ERROR,
+			DBG_IOCTL,
+			"Error writing to Spb - %!STATUS!",
+			status);
+	}
 
 	return status;
 }
@@ -173,54 +378,43 @@ SpbBurstWriteDataSynchronously(
 	IN SPB_BURST_INFO* BurstInfo,
 	IN ULONG Count
 )
+/*++
+Routine Description:
+This helper routine sends a list of writes to the Spb I/O target
+as IOCTL_SPB_EXECUTE_SEQUENCE requests. Lists longer than
+MaxSequenceTransfers are split across several sequences. Each one
+completes before the next is sent, and the first failing sequence
+ends the list, so no write after a failed one reaches the device.
+Arguments:
+SpbContext - Pointer to the current device context
+BurstInfo  - The writes to send, in order
+Count      - The number of writes in BurstInfo
+Return Value:
+NTSTATUS Status indicating success or failure
+--*/
 {
-	NTSTATUS status;
-
-	typedef struct _SPB_TRANSFER {
-		SPB_TRANSFER_LIST List;
-		SPB_TRANSFER_LIST_ENTRY ExtraTransfers[];
-	} SPB_TRANSFER;
-
-	size_t seq_size = sizeof(SPB_TRANSFER) + (sizeof(SPB_TRANSFER_LIST_ENTRY) * (Count - 1));
-	SPB_TRANSFER* seq = ExAllocatePoolWithTag(NonPagedPool, seq_size, RT5682_POOL_TAG);
-	if (!seq)
-		return STATUS_NO_MEMORY;
-
-	WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+	SPB_SYNC_WAIT wait;
+	NTSTATUS status = STATUS_SUCCESS;
 
-	SPB_TRANSFER_LIST_INIT(&(seq->List), Count);
+	for (ULONG sent = 0; sent < Count && NT_SUCCESS(status); ) {
+		ULONG chunk = min(Count - sent, SpbContext->MaxSequenceTransfers);
 
-	for (int i = 0; i < Count; i++) {
-		SPB_BURST_INFO Info = BurstInfo[i];
+		SpbSyncWaitInit(&wait);
+		SpbSyncWaitSubmit(SpbContext, &wait, &BurstInfo[sent], chunk, NULL, 0);
+		status = SpbSyncWaitFinish(&wait);
 
-		seq->List.Transfers[i] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
-			SpbTransferDirectionToDevice,
-			0,
-			Info.Data,
-			Info.Length);
+		sent += chunk;
 	}
 
-	WDF_MEMORY_DESCRIPTOR MemoryDescriptor;
-	WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
-		&MemoryDescriptor,
-		seq,
-		seq_size);
-	ULONG_PTR BytesTransferred = 0;
-	status = WdfIoTargetSendIoctlSynchronously(
-		SpbContext->SpbIoTarget,
-		NULL,
-		IOCTL_SPB_EXECUTE_SEQUENCE,
-		&MemoryDescriptor,
-		NULL,
-		NULL,
-		&BytesTransferred
-	);
-
-	WdfWaitLockRelease(SpbContext->SpbLock);
+	if (!NT_SUCCESS(status))
+	{
+		RtekPrint(
+			DEBUG_LEVEL_ERROR,
+			DBG_IOCTL,
+			"Error sending Spb write sequence - %!STATUS!",
+			status);
+	}
 
-exit:
-	if (seq)
-		ExFreePoolWithTag(seq, RT5682_POOL_TAG);
 	return status;
 }
 
@@ -235,114 +429,45 @@ SpbXferDataSynchronously(
 /*++
 Routine Description:
 This helper routine abstracts creating and sending an I/O
-request (I2C Read) to the Spb I/O target.
+request (I2C Read) to the Spb I/O target. The address write
+and the data read go out as one sequence, joined by a
+repeated start.
 Arguments:
 SpbContext - Pointer to the current device context
-Address    - The I2C register address to read from
+SendData   - The I2C register address to read from
+SendLength - The length of the register address
 Data       - A buffer to receive the data at at the above address
 Length     - The amount of data to be read from the above address
 Return Value:
 NTSTATUS Status indicating success or failure
 --*/
 {
-	PUCHAR buffer;
-	WDFMEMORY memory;
-	WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+	SPB_BURST_INFO write;
+	SPB_SYNC_WAIT wait;
 	NTSTATUS status;
-	ULONG_PTR bytesRead;
 
-	WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+	write.Data = SendData;
+	write.Length = SendLength;
 
-	memory = NULL;
-	status = STATUS_INVALID_PARAMETER;
-	bytesRead = 0;
+	SpbSyncWaitInit(&wait);
+	SpbSyncWaitSubmit(SpbContext, &wait, &write, 1, Data, Length);
+	status = SpbSyncWaitFinish(&wait);
 
-	//
-	// Xfer transactions start by writing an address pointer
-	//
-	status = SpbDoWriteDataSynchronously(
-		SpbContext,
-		SendData,
-		SendLength);
-
-	if (!NT_SUCCESS(status))
+	if (NT_SUCCESS(status) &&
+		wait.BytesTransferred != SendLength + Length)
 	{
-		RtekPrint(
-			DEBUG_LEVEL_ERROR,
-			DBG_IOCTL,
-			"Error setting address pointer for Spb read - %!STATUS!",
-			status);
-		goto exit;
-	}
-
-	if (Length > DEFAULT_SPB_BUFFER_SIZE)
-	{
-		status = WdfMemoryCreate(
-			WDF_NO_OBJECT_ATTRIBUTES,
-			NonPagedPool,
-			RT5682_POOL_TAG,
-			Length,
-			&memory,
-			(PVOID*)&buffer);
-
-		if (!NT_SUCCESS(status))
-		{
-			RtekPrint(
-				DEBUG_LEVEL_ERROR,
-				DBG_IOCTL,
-				"Error allocating memory for Spb read - %!STATUS!",
-				status);
-			goto exit;
-		}
-
-		WDF_MEMORY_DESCRIPTOR_INIT_HANDLE(
-			&memoryDescriptor,
-			memory,
-			NULL);
-	}
-	else
-	{
-		buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->ReadMemory, NULL);
-
-		WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
-			&memoryDescriptor,
-			(PVOID)buffer,
-			Length);
+		status = STATUS_DEVICE_PROTOCOL_ERROR;
 	}
 
-
-	status = WdfIoTargetSendReadSynchronously(
-		SpbContext->SpbIoTarget,
-		NULL,
-		&memoryDescriptor,
-		NULL,
-		NULL,
-		&bytesRead);
-
-	if (!NT_SUCCESS(status) ||
-		bytesRead != Length)
+	if (!NT_SUCCESS(status))
 	{
 		RtekPrint(
 			DEBUG_LEVEL_ERROR,
 			DBG_IOCTL,
 			"Error reading from Spb - %!STATUS!",
 			status);
-		goto exit;
-	}
-
-	//
-	// Copy back to the caller's buffer
-	//
-	RtlCopyMemory(Data, buffer, Length);
-
-exit:
-	if (NULL != memory)
-	{
-		WdfObjectDelete(memory);
 	}
 
-	WdfWaitLockRelease(SpbContext->SpbLock);
-
 	return status;
 }
 
@@ -374,22 +499,20 @@ NTSTATUS Status indicating success or failure
 	UNREFERENCED_PARAMETER(SpbContext);
 
 	//
-	// Free any SPB_CONTEXT allocations here
+	// Free any SPB_CONTEXT allocations here. Every request slot is
+	// reclaimed first so nothing is still in flight.
 	//
-	if (SpbContext->SpbLock != NULL)
-	{
-		WdfObjectDelete(SpbContext->SpbLock);
-	}
-
-	if (SpbContext->ReadMemory != NULL)
+	for (ULONG i = 0; i < SpbContext->AsyncDepth; i++)
 	{
-		WdfObjectDelete(SpbContext->ReadMemory);
+		KeWaitForSingleObject(&SpbContext->AsyncSlots, Executive, KernelMode, FALSE, NULL);
 	}
 
-	if (SpbContext->WriteMemory != NULL)
+	for (ULONG i = 0; i < SpbContext->AsyncDepth; i++)
 	{
-		WdfObjectDelete(SpbContext->WriteMemory);
+		WdfObjectDelete(SpbContext->AsyncRequests[i].Request);
+		RtlZeroMemory(&SpbContext->AsyncRequests[i], sizeof(SPB_ASYNC_REQUEST));
 	}
+	SpbContext->AsyncDepth = 0;
 }
 
 NTSTATUS
@@ -425,6 +548,10 @@ NTSTATUS Status indicating success or failure
 	WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
 	objectAttributes.ParentObject = FxDevice;
 
+	if (SpbContext->MaxSequenceTransfers == 0)
+		SpbContext->MaxSequenceTransfers = DEFAULT_SPB_MAX_SEQUENCE_TRANSFERS;
+	SpbContext->MaxSequenceTransfers = min(SpbContext->MaxSequenceTransfers, SPB_MAX_SEQUENCE_TRANSFERS);
+
 	status = WdfIoTargetCreate(
 		FxDevice,
 		&objectAttributes,
@@ -484,60 +611,64 @@ NTSTATUS Status indicating success or failure
 	}
 
 	//
-	// Allocate some fixed-size buffers from NonPagedPool for typical
-	// Spb transaction sizes to avoid pool fragmentation in most cases
+	// Create the preformatted request slots. Each one owns a buffer holding
+	// a transfer list of MaxSequenceTransfers writes plus one read, followed
+	// by DEFAULT_SPB_ASYNC_DATA_SIZE bytes of write data.
 	//
-	status = WdfMemoryCreate(
-		WDF_NO_OBJECT_ATTRIBUTES,
-		NonPagedPool,
-		RT5682_POOL_TAG,
-		DEFAULT_SPB_BUFFER_SIZE,
-		&SpbContext->WriteMemory,
-		NULL);
+	SpbContext->AsyncDataOffset = ALIGN_UP_BY(
+		(ULONG)SPB_TRANSFER_SIZE(SpbContext->MaxSequenceTransfers + 1),
+		MEMORY_ALLOCATION_ALIGNMENT);
+	SpbContext->AsyncInUse = 0;
+	KeInitializeSemaphore(&SpbContext->AsyncSlots, 0, DEFAULT_SPB_ASYNC_DEPTH);
 
-	if (!NT_SUCCESS(status))
+	for (ULONG i = 0; i < DEFAULT_SPB_ASYNC_DEPTH; i++)
 	{
-		RtekPrint(
-			DEBUG_LEVEL_ERROR,
-			DBG_IOCTL,
-			"Error allocating default memory for Spb write - %!STATUS!",
-			status);
-		goto exit;
-	}
+		SPB_ASYNC_REQUEST* asyncRequest = &SpbContext->AsyncRequests[i];
 
-	status = WdfMemoryCreate(
-		WDF_NO_OBJECT_ATTRIBUTES,
-		NonPagedPool,
-		RT5682_POOL_TAG,
-		DEFAULT_SPB_BUFFER_SIZE,
-		&SpbContext->ReadMemory,
-		NULL);
+		WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+		objectAttributes.ParentObject = FxDevice;
 
-	if (!NT_SUCCESS(status))
-	{
-		RtekPrint(
-			DEBUG_LEVEL_ERROR,
-			DBG_IOCTL,
-			"Error allocating default memory for Spb read - %!STATUS!",
-			status);
-		goto exit;
-	}
+		status = WdfRequestCreate(
+			&objectAttributes,
+			SpbContext->SpbIoTarget,
+			&asyncRequest->Request);
 
-	//
-	// Allocate a waitlock to guard access to the default buffers
-	//
-	status = WdfWaitLockCreate(
-		WDF_NO_OBJECT_ATTRIBUTES,
-		&SpbContext->SpbLock);
+		if (!NT_SUCCESS(status))
+		{
+			RtekPrint(
+				DEBUG_LEVEL_ERROR,
+				DBG_IOCTL,
+				"Error creating Spb request - %!STATUS!",
+				status);
+			goto exit;
+		}
 
-	if (!NT_SUCCESS(status))
-	{
-		RtekPrint(
-			DEBUG_LEVEL_ERROR,
-			DBG_IOCTL,
-			"Error creating Spb Waitlock - %!STATUS!",
-			status);
-		goto exit;
+		WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+		objectAttributes.ParentObject = asyncRequest->Request;
+
+		status = WdfMemoryCreate(
+			&objectAttributes,
+			NonPagedPool,
+			RT5682_POOL_TAG,
+			SpbContext->AsyncDataOffset + DEFAULT_SPB_ASYNC_DATA_SIZE,
+			&asyncRequest->Memory,
+			(PVOID*)&asyncRequest->Buffer);
+
+		if (!NT_SUCCESS(status))
+		{
+			RtekPrint(
+				DEBUG_LEVEL_ERROR,
+				DBG_IOCTL,
+				"Error allocating memory for Spb request - %!STATUS!",
+				status);
+			WdfObjectDelete(asyncRequest->Request);
+			asyncRequest->Request = NULL;
+			goto exit;
+		}
+
+		asyncRequest->SpbContext = SpbContext;
+		SpbContext->AsyncDepth++;
+		KeReleaseSemaphore(&SpbContext->AsyncSlots, IO_NO_INCREMENT, 1, FALSE);
 	}
 
 exit:
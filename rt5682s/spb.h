@@ -23,9 +23,47 @@ Revision History:
 #include <wdm.h>
 #include <wdf.h>
 
-#define DEFAULT_SPB_BUFFER_SIZE 64
+#define DEFAULT_SPB_MAX_SEQUENCE_TRANSFERS 16
+#define DEFAULT_SPB_ASYNC_DEPTH 4
+#define DEFAULT_SPB_ASYNC_DATA_SIZE 256
+// A register write is at least 4 bytes, more would not fit a request slot
+#define SPB_MAX_SEQUENCE_TRANSFERS (DEFAULT_SPB_ASYNC_DATA_SIZE / 4)
 #define RESHUB_USE_HELPER_ROUTINES
 
+typedef struct _SPB_BURST_INFO {
+	PVOID Data;
+	ULONG Length;
+} SPB_BURST_INFO;
+
+//
+// Called once for every successfully submitted asynchronous sequence,
+// possibly at DISPATCH_LEVEL. The request slot is released only after the
+// routine returns. It must not submit more work, because a submit waits
+// for a free slot.
+//
+typedef VOID
+SPB_ASYNC_COMPLETION(
+	_In_ NTSTATUS Status,
+	_In_ ULONG_PTR BytesTransferred,
+	_In_opt_ PVOID Context
+);
+typedef SPB_ASYNC_COMPLETION* PSPB_ASYNC_COMPLETION;
+
+//
+// Preformatted request slot. Memory holds the transfer list followed by
+// a copy of the write data, so callers may reuse their write buffers as
+// soon as the submit call returns.
+//
+typedef struct _SPB_ASYNC_REQUEST
+{
+	struct _SPB_CONTEXT* SpbContext;
+	WDFREQUEST Request;
+	WDFMEMORY Memory;
+	PUCHAR Buffer;
+	PSPB_ASYNC_COMPLETION Completion;
+	PVOID CompletionContext;
+} SPB_ASYNC_REQUEST;
+
 //
 // SPB (I2C) context
 //
@@ -34,11 +72,30 @@ typedef struct _SPB_CONTEXT
 {
 	WDFIOTARGET SpbIoTarget;
 	LARGE_INTEGER I2cResHubId;
-	WDFMEMORY WriteMemory;
-	WDFMEMORY ReadMemory;
-	WDFWAITLOCK SpbLock;
+	ULONG MaxSequenceTransfers;	//0 for the default, set before initialize
+
+	//
+	// Bounded set of in-flight requests. AsyncSlots counts free slots and
+	// AsyncInUse has one bit per slot in AsyncRequests.
+	//
+	SPB_ASYNC_REQUEST AsyncRequests[DEFAULT_SPB_ASYNC_DEPTH];
+	ULONG AsyncDepth;
+	ULONG AsyncDataOffset;
+	KSEMAPHORE AsyncSlots;
+	volatile LONG AsyncInUse;
 } SPB_CONTEXT;
 
+NTSTATUS
+SpbSendSequenceAsync(
+	IN SPB_CONTEXT* SpbContext,
+	IN SPB_BURST_INFO* Writes,
+	IN ULONG WriteCount,
+	IN PVOID ReadData,
+	IN ULONG ReadLength,
+	IN PSPB_ASYNC_COMPLETION Completion,
+	IN PVOID Context
+);
+
 NTSTATUS
 SpbXferDataSynchronously(
 	_In_ SPB_CONTEXT* SpbContext,
@@ -67,11 +124,6 @@ SpbWriteDataSynchronously(
 	IN ULONG Length
 );
 
-typedef struct _SPB_BURST_INFO {
-	PVOID Data;
-	ULONG Length;
-} SPB_BURST_INFO;
-
 NTSTATUS
 SpbBurstWriteDataSynchronously(
 	IN SPB_CONTEXT* SpbContext,